@@ -0,0 +1,102 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <kigumi/Face_tag.h>
+#include <kigumi/Find_possibly_intersecting_faces.h>
+#include <kigumi/Null_data.h>
+#include <kigumi/Triangle_soup.h>
+#include <kigumi/Triangle_soup_io.h>
+#include <kigumi/boolean_options.h>
+
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "make_sheet.h"
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Find_possibly_intersecting_faces =
+    kigumi::Find_possibly_intersecting_faces<K, kigumi::Null_data>;
+using Triangle_soup = kigumi::Triangle_soup<K>;
+using kigumi::Boolean_context;
+using kigumi::Broad_phase_strategy;
+using kigumi::Face_tag;
+using kigumi::read_triangle_soup;
+
+namespace {
+
+// Returns the time in milliseconds and the number of pairs found.
+std::pair<double, std::size_t> run(const Triangle_soup& left, const Triangle_soup& right,
+                                   Broad_phase_strategy strategy) {
+  auto opts = Boolean_context::current();
+  opts.set_broad_phase_strategy(strategy);
+  Boolean_context ctx{opts};
+
+  // Copies do not share the cached AABB trees, so the build time is included.
+  Triangle_soup left_copy{left};
+  Triangle_soup right_copy{right};
+  std::vector<Face_tag> left_face_tags(left.num_faces());
+  std::vector<Face_tag> right_face_tags(right.num_faces());
+
+  auto start = std::chrono::high_resolution_clock::now();
+  auto pairs =
+      Find_possibly_intersecting_faces{}(left_copy, right_copy, left_face_tags, right_face_tags);
+  auto end = std::chrono::high_resolution_clock::now();
+
+  return {std::chrono::duration<double, std::milli>(end - start).count(), pairs.size()};
+}
+
+void print_row(const Triangle_soup& left, const Triangle_soup& right) {
+  auto [tree_ms, tree_pairs] = run(left, right, Broad_phase_strategy::AABB_TREE);
+  auto [grid_ms, grid_pairs] = run(left, right, Broad_phase_strategy::UNIFORM_GRID);
+  auto [auto_ms, auto_pairs] = run(left, right, Broad_phase_strategy::AUTOMATIC);
+  if (tree_pairs != grid_pairs || tree_pairs != auto_pairs) {
+    throw std::runtime_error("the strategies found different numbers of pairs");
+  }
+
+  std::cout << std::setw(12) << left.num_faces() + right.num_faces() << std::setw(12)
+            << tree_pairs << std::setw(12) << tree_ms << std::setw(12) << grid_ms << std::setw(12)
+            << auto_ms << std::setw(12) << (grid_ms < tree_ms ? "grid" : "tree") << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  try {
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << std::setw(12) << "faces" << std::setw(12) << "pairs" << std::setw(12)
+              << "tree (ms)" << std::setw(12) << "grid (ms)" << std::setw(12) << "auto (ms)"
+              << std::setw(12) << "faster"
+              << std::endl;
+
+    if (args.size() >= 2) {
+      Triangle_soup left;
+      Triangle_soup right;
+      if (!read_triangle_soup(args.at(0), left) || !read_triangle_soup(args.at(1), right)) {
+        throw std::runtime_error("reading failed");
+      }
+      print_row(left, right);
+      return 0;
+    }
+
+    // Sweep over the resolution to find the crossover point.
+    for (std::size_t n = 8; n <= 1024; n *= 2) {
+      auto left = make_sheet<K>(n, 0.0, 0.0);
+      auto right = make_sheet<K>(n, 0.25, 1.0);
+      print_row(left, right);
+    }
+
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 1;
+  }
+}
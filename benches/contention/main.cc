@@ -0,0 +1,117 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <CGAL/enum.h>
+#include <kigumi/Find_defects.h>
+#include <kigumi/Null_data.h>
+#include <kigumi/Side_of_triangle_soup.h>
+#include <kigumi/Triangle_soup.h>
+#include <kigumi/parallel_do.h>
+#include <kigumi/threading.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "make_cube.h"
+#include "subdivide.h"
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Find_defects = kigumi::Find_defects<K, kigumi::Null_data>;
+using Point = K::Point_3;
+using Side_of_triangle_soup = kigumi::Side_of_triangle_soup<K, kigumi::Null_data>;
+using Triangle_soup = kigumi::Triangle_soup<K>;
+using kigumi::parallel_do;
+using kigumi::Threading_context;
+
+namespace {
+
+template <class F>
+double measure(F f) {
+  auto start = std::chrono::high_resolution_clock::now();
+  f();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // namespace
+
+// Measures how the phases that share the vertices among the threads scale with the number of
+// threads. Contention on the reference counts of the points shows up as poor scaling.
+int main(int argc, char* argv[]) {
+  try {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    auto num_levels = args.empty() ? 7 : std::stoi(args.at(0));
+
+    // The surface of the unit cube with 12 * 4^num_levels faces.
+    auto soup = make_cube<K>({0, 0, 0}, {1, 1, 1}, {}).boundary();
+    for (auto i = 0; i < num_levels; ++i) {
+      soup = subdivide(soup);
+    }
+    // Build the tree in advance.
+    soup.aabb_tree();
+
+    std::mt19937 gen{0};
+    std::uniform_real_distribution<double> dist{0.1, 0.9};
+    std::vector<Point> queries;
+    for (auto i = 0; i < 10000; ++i) {
+      queries.emplace_back(dist(gen), dist(gen), dist(gen));
+    }
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "faces: " << soup.num_faces() << ", queries: " << queries.size() << std::endl;
+    std::cout << std::setw(12) << "threads" << std::setw(16) << "defects (ms)" << std::setw(16)
+              << "side of (ms)" << std::endl;
+
+    auto max_threads = std::max(1U, std::thread::hardware_concurrency());
+    for (std::size_t num_threads = 1;; num_threads = std::min(2 * num_threads, max_threads)) {
+      auto opts = Threading_context::current();
+      opts.set_num_threads(num_threads);
+      Threading_context ctx{opts};
+
+      auto defects_ms = measure([&] {
+        Find_defects defects{soup};
+        if (!defects.non_trivial_degenerate_faces().empty() ||
+            !defects.overlapping_faces().empty()) {
+          throw std::runtime_error("unexpected defects");
+        }
+      });
+
+      std::atomic<std::size_t> num_inside{};
+      auto side_of_ms = measure([&] {
+        parallel_do(
+            queries.begin(), queries.end(), Side_of_triangle_soup{},
+            [&](const Point& p, auto& side_of) {
+              if (side_of(soup, p) == CGAL::ON_NEGATIVE_SIDE) {
+                ++num_inside;
+              }
+            },
+            [](auto& /*side_of*/) {});
+      });
+      if (num_inside != queries.size()) {
+        throw std::runtime_error("unexpected sides");
+      }
+
+      std::cout << std::setw(12) << num_threads << std::setw(16) << defects_ms << std::setw(16)
+                << side_of_ms << std::endl;
+
+      if (num_threads == max_threads) {
+        break;
+      }
+    }
+
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 1;
+  }
+}
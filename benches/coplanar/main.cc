@@ -0,0 +1,85 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <kigumi/Boolean_operator.h>
+#include <kigumi/Boolean_region_builder.h>
+#include <kigumi/Null_data.h>
+#include <kigumi/Region.h>
+#include <kigumi/Triangle_soup.h>
+
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "make_cube.h"
+#include "subdivide.h"
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Boolean_region_builder = kigumi::Boolean_region_builder<K, kigumi::Null_data>;
+using Point = K::Point_3;
+using Region = kigumi::Region<K, kigumi::Null_data>;
+using kigumi::Boolean_operator;
+
+namespace {
+
+Region make_subdivided_box(const Point& min, const Point& max, int num_levels) {
+  auto soup = make_cube<K>(min, max, {}).boundary();
+  for (auto i = 0; i < num_levels; ++i) {
+    soup = subdivide(soup);
+  }
+  return Region{std::move(soup)};
+}
+
+template <class F>
+double measure(F f) {
+  auto start = std::chrono::high_resolution_clock::now();
+  f();
+  auto end = std::chrono::high_resolution_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+}  // namespace
+
+// Measures the Boolean operations between two boxes whose top and bottom faces lie on the same
+// planes. The faces are subdivided at different levels so that the shared planes carry many
+// coplanar, partially overlapping face pairs, which is the load of the coplanar path.
+int main(int argc, char* argv[]) {
+  try {
+    std::vector<std::string> args(argv + 1, argv + argc);
+    auto num_levels = args.empty() ? 5 : std::stoi(args.at(0));
+
+    auto a = make_subdivided_box({0, 0, 0}, {2, 2, 1}, num_levels);
+    auto b = make_subdivided_box({1, 1, 0}, {3, 3, 1}, num_levels + 1);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "faces: " << a.boundary().num_faces() << " + " << b.boundary().num_faces()
+              << std::endl;
+
+    std::optional<Boolean_region_builder> builder;
+    auto build_ms = measure([&] { builder.emplace(a, b); });
+
+    Region u;
+    auto union_ms = measure([&] { u = (*builder)(Boolean_operator::UNION); });
+
+    Region i;
+    auto intersection_ms = measure([&] { i = (*builder)(Boolean_operator::INTERSECTION); });
+
+    std::cout << std::setw(16) << "build (ms)" << std::setw(16) << "union (ms)" << std::setw(20)
+              << "intersection (ms)" << std::endl;
+    std::cout << std::setw(16) << build_ms << std::setw(16) << union_ms << std::setw(20)
+              << intersection_ms << std::endl;
+    std::cout << "result faces: " << u.boundary().num_faces() << " (union), "
+              << i.boundary().num_faces() << " (intersection)" << std::endl;
+
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "error: " << e.what() << std::endl;
+    return 1;
+  } catch (...) {
+    std::cerr << "unknown error" << std::endl;
+    return 1;
+  }
+}
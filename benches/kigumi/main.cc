@@ -5,6 +5,7 @@
 #include <kigumi/Boolean_region_builder.h>
 #include <kigumi/Region.h>
 #include <kigumi/Triangle_soup_io.h>
+#include <kigumi/boolean_options.h>
 #include <kigumi/threading.h>
 
 #include <chrono>
@@ -16,10 +17,17 @@
 
 #include "../cli/utility.h"
 
+#if defined(KIGUMI_USE_MIMALLOC)
+// Overrides new and delete, through which the lazy-exact nodes are allocated from many threads.
+#include <mimalloc-new-delete.h>
+#endif
+
 using K = CGAL::Exact_predicates_exact_constructions_kernel;
 using Region = kigumi::Region<K>;
+using kigumi::Boolean_context;
 using kigumi::Boolean_operator;
 using kigumi::Boolean_region_builder;
+using kigumi::Broad_phase_strategy;
 using kigumi::read_triangle_soup;
 using kigumi::Threading_context;
 using kigumi::write_triangle_soup;
@@ -35,6 +43,26 @@ int main(int argc, char* argv[]) {
     std::cout << "num_threads: " << Threading_context::current().num_threads()
               << " (can be set with the environment variable KIGUMI_NUM_THREADS)" << std::endl;
 
+    const auto* env_broad_phase = std::getenv("KIGUMI_BROAD_PHASE");
+    std::string broad_phase{env_broad_phase != nullptr ? env_broad_phase : "auto"};
+    auto boolean_opts = Boolean_context::current();
+    if (broad_phase == "tree") {
+      boolean_opts.set_broad_phase_strategy(Broad_phase_strategy::AABB_TREE);
+    } else if (broad_phase == "grid") {
+      boolean_opts.set_broad_phase_strategy(Broad_phase_strategy::UNIFORM_GRID);
+    }
+    const auto* env_inexact = std::getenv("KIGUMI_INEXACT");
+    boolean_opts.set_inexact_mode(env_inexact != nullptr && std::string{env_inexact} == "1");
+    const auto* env_round = std::getenv("KIGUMI_ROUND");
+    boolean_opts.set_round_result(env_round != nullptr && std::string{env_round} == "1");
+    Boolean_context boolean_ctx{boolean_opts};
+    std::cout << "broad_phase: " << broad_phase
+              << " (can be set with the environment variable KIGUMI_BROAD_PHASE)" << std::endl;
+    std::cout << "inexact: " << (boolean_opts.inexact_mode() ? "on" : "off")
+              << " (can be enabled with the environment variable KIGUMI_INEXACT=1)" << std::endl;
+    std::cout << "round: " << (boolean_opts.round_result() ? "on" : "off")
+              << " (can be enabled with the environment variable KIGUMI_ROUND=1)" << std::endl;
+
     std::vector<std::string> args(argv + 1, argv + argc);
 
     Region first;
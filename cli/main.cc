@@ -7,6 +7,11 @@
 
 #include "commands.h"
 
+#if defined(KIGUMI_USE_MIMALLOC)
+// Overrides new and delete, through which the lazy-exact nodes are allocated from many threads.
+#include <mimalloc-new-delete.h>
+#endif
+
 int main(int argc, const char* argv[]) {
   try {
     std::vector<std::string> args(argv + 1, argv + argc);
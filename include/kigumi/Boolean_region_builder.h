@@ -3,12 +3,16 @@
 #include <kigumi/Boolean_operator.h>
 #include <kigumi/Extract.h>
 #include <kigumi/Face_tag.h>
+#include <kigumi/Inexact_mix.h>
 #include <kigumi/Mix.h>
 #include <kigumi/Mixed.h>
 #include <kigumi/Region.h>
+#include <kigumi/Round_vertices.h>
 #include <kigumi/Warnings.h>
+#include <kigumi/boolean_options.h>
 
 #include <algorithm>
+#include <iostream>
 #include <iterator>
 #include <stdexcept>
 #include <tuple>
@@ -20,6 +24,7 @@ namespace kigumi {
 template <class K, class FaceData>
 class Boolean_region_builder {
   using Extract = Extract<K, FaceData>;
+  using Inexact_mix = Inexact_mix<K, FaceData>;
   using Mix = Mix<K, FaceData>;
   using Mixed_face_data = Mixed_face_data<FaceData>;
   using Mixed_triangle_soup = Mixed_triangle_soup<K, FaceData>;
@@ -72,12 +77,23 @@ class Boolean_region_builder {
       return;
     }
 
+    if (Boolean_context::current().inexact_mode()) {
+      if (auto result = Inexact_mix{}(a.boundary_, b.boundary_)) {
+        std::tie(m_, warnings_) = std::move(*result);
+        return;
+      }
+      std::cout << "Falling back to the exact path..." << std::endl;
+    }
+
     std::tie(m_, warnings_) = Mix{}(a.boundary_, b.boundary_);
   }
 
   Region operator()(Boolean_operator op, bool prefer_first = true) const {
     auto soup = Extract{}(m_, op, prefer_first);
     if (soup.num_faces() != 0) {
+      if (Boolean_context::current().round_result()) {
+        round_vertices(soup);
+      }
       return Region{std::move(soup)};
     }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <CGAL/version.h>
+#include <kigumi/Face_face_filter.h>
 #include <kigumi/Face_face_intersection.h>
 #include <kigumi/Face_tag.h>
 #include <kigumi/Find_coplanar_faces.h>
@@ -11,14 +13,23 @@
 #include <kigumi/Triangle_region.h>
 #include <kigumi/Triangle_soup.h>
 #include <kigumi/Triangulation.h>
+#include <kigumi/boolean_options.h>
+#include <kigumi/mesh_utility.h>
 #include <kigumi/parallel_do.h>
+#include <kigumi/parallel_sort.h>
+#include <kigumi/threading.h>
 
 #include <algorithm>
+#include <array>
 #include <boost/container/static_vector.hpp>
+#include <boost/iterator/counting_iterator.hpp>
 #include <boost/range/iterator_range.hpp>
 #include <boost/unordered/unordered_flat_map.hpp>
+#include <cmath>
+#include <cstddef>
 #include <functional>
 #include <iostream>
+#include <iterator>
 #include <optional>
 #include <stdexcept>
 #include <tuple>
@@ -29,6 +40,7 @@ namespace kigumi {
 
 template <class K, class FaceData>
 class Corefine {
+  using Face_face_filter = Face_face_filter<K>;
   using Face_face_intersection = Face_face_intersection<K>;
   using Find_coplanar_faces = Find_coplanar_faces<K, FaceData>;
   using Find_possibly_intersecting_faces = Find_possibly_intersecting_faces<K, FaceData>;
@@ -42,82 +54,115 @@ class Corefine {
   Corefine(const Triangle_soup& left, const Triangle_soup& right) : left_{left}, right_{right} {
     std::cout << "Finding face pairs..." << std::endl;
 
-    points_.start_uniqueness_check();
-    points_.reserve(left_.num_vertices() + right_.num_vertices());
+    std::vector<const Point*> input_points;
+    input_points.reserve(left_.num_vertices() + right_.num_vertices());
     for (auto vi : left_.vertices()) {
-      left_point_ids_.push_back(points_.insert(left_.point(vi)));
+      input_points.push_back(&left_.point(vi));
     }
     for (auto vi : right_.vertices()) {
-      right_point_ids_.push_back(points_.insert(right_.point(vi)));
+      input_points.push_back(&right_.point(vi));
     }
-    points_.stop_uniqueness_check();
+    auto point_ids = points_.insert_unique(input_points);
+    auto left_end = point_ids.begin() + static_cast<std::ptrdiff_t>(left_.num_vertices());
+    left_point_ids_.assign(point_ids.begin(), left_end);
+    right_point_ids_.assign(left_end, point_ids.end());
 
     std::tie(left_face_tags_, right_face_tags_) =
         Find_coplanar_faces{}(left_, right_, left_point_ids_, right_point_ids_);
 
-    auto pairs =
-        Find_possibly_intersecting_faces{}(left_, right_, left_face_tags_, right_face_tags_);
-
     std::cout << "Finding symbolic intersections..." << std::endl;
 
-    std::size_t num_intersections{};
-    parallel_do(
-        pairs.begin(), pairs.end(), std::pair<std::vector<Intersection_info>, std::size_t>{},
-        [&](const auto& pair, auto& local_state) {
-          thread_local Face_face_intersection face_face_intersection{points_};
-
-          auto [left_fi, right_fi] = pair;
-          const auto& left_face = left_.face(left_fi);
-          const auto& right_face = right_.face(right_fi);
-          auto a = left_point_ids_.at(left_face[0].idx());
-          auto b = left_point_ids_.at(left_face[1].idx());
-          auto c = left_point_ids_.at(left_face[2].idx());
-          auto p = right_point_ids_.at(right_face[0].idx());
-          auto q = right_point_ids_.at(right_face[1].idx());
-          auto r = right_point_ids_.at(right_face[2].idx());
-          auto sym_inters = face_face_intersection(a, b, c, p, q, r);
-          if (sym_inters.empty()) {
-            return;
+    // The candidate pairs are tested as soon as they are found, and only the intersecting ones
+    // are kept. Most of them are rejected by the batched filter without evaluating exact
+    // predicates.
+    Face_face_filter face_face_filter{points_};
+    std::size_t num_cache_hits{};
+    std::size_t num_cache_misses{};
+    auto plan = Find_possibly_intersecting_faces{}(
+        left_, right_, left_face_tags_, right_face_tags_,
+        std::pair<Face_face_intersection, std::vector<Intersection_info>>{
+            Face_face_intersection{points_}, {}},
+        [&](const auto& pairs, auto& local_state) {
+          auto& [face_face_intersection, local_infos] = local_state;
+          thread_local std::vector<typename Face_face_filter::Face_pair> face_pairs;
+          thread_local std::vector<typename Face_face_filter::Signs> signs;
+
+          face_pairs.clear();
+          for (auto [left_fi, right_fi] : pairs) {
+            const auto& left_face = left_.face(left_fi);
+            const auto& right_face = right_.face(right_fi);
+            face_pairs.push_back({
+                left_point_ids_.at(left_face[0].idx()),
+                left_point_ids_.at(left_face[1].idx()),
+                left_point_ids_.at(left_face[2].idx()),
+                right_point_ids_.at(right_face[0].idx()),
+                right_point_ids_.at(right_face[1].idx()),
+                right_point_ids_.at(right_face[2].idx()),
+            });
+          }
+          face_face_filter(face_pairs, signs);
+
+          std::size_t i{};
+          for (auto [left_fi, right_fi] : pairs) {
+            const auto& s = signs.at(i);
+            auto [a, b, c, p, q, r] = face_pairs.at(i);
+            ++i;
+            if (Face_face_filter::is_separated(s)) {
+              continue;
+            }
+            // Let the exact path reuse the signs certified by the filter.
+            std::array abc{a, b, c};
+            std::array pqr{p, q, r};
+            for (std::size_t j = 0; j < 3; ++j) {
+              if (s.at(j) != 0) {
+                face_face_intersection.cache_orientation(p, q, r, abc.at(j),
+                                                         static_cast<CGAL::Orientation>(s.at(j)));
+              }
+              if (s.at(3 + j) != 0) {
+                face_face_intersection.cache_orientation(
+                    a, b, c, pqr.at(j), static_cast<CGAL::Orientation>(s.at(3 + j)));
+              }
+            }
+            auto sym_inters = face_face_intersection(a, b, c, p, q, r);
+            if (sym_inters.empty()) {
+              continue;
+            }
+            local_infos.emplace_back(left_fi, right_fi, sym_inters);
           }
-          auto& [local_infos, local_num_intersections] = local_state;
-          local_infos.emplace_back(left_fi, right_fi, sym_inters);
-          local_num_intersections += sym_inters.size();
         },
         [&](auto& local_state) {
-          auto& [local_infos, local_num_intersections] = local_state;
+          auto& [face_face_intersection, local_infos] = local_state;
           if (infos_.empty()) {
             infos_ = std::move(local_infos);
           } else {
             infos_.insert(infos_.end(), local_infos.begin(), local_infos.end());
           }
-          num_intersections += local_num_intersections;
+          num_cache_hits += face_face_intersection.num_cache_hits();
+          num_cache_misses += face_face_intersection.num_cache_misses();
         });
 
-    std::cout << "Constructing intersection points..." << std::endl;
-
-    auto num_points_before_insertion = points_.size();
+    std::cout << "  components: " << plan.num_left_components << " + "
+              << plan.num_right_components << " (" << plan.num_component_pairs
+              << " overlapping pairs)" << std::endl;
+    std::cout << "  broad phase: "
+              << (plan.strategy == Broad_phase_strategy::UNIFORM_GRID ? "grid" : "tree")
+              << " over the " << (plan.index_left ? "first" : "second") << " mesh ("
+              << plan.num_index_faces << " faces, " << plan.num_query_faces << " queries)"
+              << std::endl;
+    std::cout << "  estimated face pairs: " << std::llround(plan.model_num_pairs) << " (model), "
+              << std::llround(plan.sampled_num_pairs) << " (sampled)" << std::endl;
+    std::cout << "  threads: " << plan.num_threads << std::endl;
+    std::cout << "  orientation cache: " << num_cache_hits << " hits, " << num_cache_misses
+              << " misses" << std::endl;
+
+    // The later phases scale with the number of pairs as well.
+    auto threading_opts = Threading_context::current();
+    threading_opts.set_num_threads(plan.num_threads);
+    Threading_context threading_ctx{threading_opts};
 
-    points_.reserve(num_points_before_insertion + num_intersections / 2);
-    Intersection_point_inserter inserter(points_);
-    for (auto& info : infos_) {
-      const auto& left_face = left_.face(info.left_fi);
-      const auto& right_face = right_.face(info.right_fi);
-      auto a = left_point_ids_.at(left_face[0].idx());
-      auto b = left_point_ids_.at(left_face[1].idx());
-      auto c = left_point_ids_.at(left_face[2].idx());
-      auto p = right_point_ids_.at(right_face[0].idx());
-      auto q = right_point_ids_.at(right_face[1].idx());
-      auto r = right_point_ids_.at(right_face[2].idx());
-      for (auto sym_inter : info.symbolic_intersections) {
-        auto left_region = intersection(sym_inter, Triangle_region::LEFT_FACE);
-        auto right_region = intersection(sym_inter, Triangle_region::RIGHT_FACE);
-        auto id = inserter.insert(left_region, a, b, c, right_region, p, q, r);
-        info.intersections.push_back(id);
-      }
-    }
+    std::cout << "Constructing intersection points..." << std::endl;
 
-    parallel_do(points_.begin() + num_points_before_insertion, points_.end(),
-                [](const auto& p) { p.exact(); });
+    construct_intersection_points();
 
     std::cout << "Triangulating..." << std::endl;
 
@@ -133,31 +178,29 @@ class Corefine {
       first = last;
     }
 
-    left_triangulations_.reserve(ranges.size());
-    for (const auto& range : ranges) {
-      const auto& any_info = range.front();
-      auto fi = any_info.left_fi;
-      left_triangulations_.emplace(fi, std::nullopt);
-    }
-
     try {
-      parallel_do(ranges.begin(), ranges.end(), [&](const auto& range) {
-        const auto& any_info = range.front();
-        auto fi = any_info.left_fi;
-        const auto& f = left_.face(fi);
-        auto a = left_point_ids_.at(f[0].idx());
-        auto b = left_point_ids_.at(f[1].idx());
-        auto c = left_point_ids_.at(f[2].idx());
-        const auto& pa = points_.at(a);
-        const auto& pb = points_.at(b);
-        const auto& pc = points_.at(c);
-
-        auto& triangulation =
-            left_triangulations_.at(fi).emplace(Triangle_region::LEFT_FACE, pa, pb, pc, a, b, c);
-        for (const auto& info : range) {
-          insert_intersection(triangulation, info);
-        }
-      });
+      parallel_do(
+          ranges.begin(), ranges.end(), std::pair<Triangulation, Triangulated_faces>{},
+          [&](const auto& range, auto& local_state) {
+            auto& [triangulation, local_faces] = local_state;
+            const auto& any_info = range.front();
+            auto fi = any_info.left_fi;
+            const auto& f = left_.face(fi);
+            auto a = left_point_ids_.at(f[0].idx());
+            auto b = left_point_ids_.at(f[1].idx());
+            auto c = left_point_ids_.at(f[2].idx());
+            const auto& pa = points_.at(a);
+            const auto& pb = points_.at(b);
+            const auto& pc = points_.at(c);
+
+            triangulation.reset(Triangle_region::LEFT_FACE, pa, pb, pc, a, b, c);
+            for (const auto& info : range) {
+              insert_intersection(triangulation, info);
+            }
+            auto count = triangulation.get_faces(std::back_inserter(local_faces.faces));
+            local_faces.counts.emplace_back(fi, count);
+          },
+          [&](auto& local_state) { left_faces_.append(local_state.second); });
     } catch (const typename Triangulation::Intersection_of_constraints_exception&) {
       throw std::runtime_error("the second mesh has self-intersections");
     }
@@ -174,31 +217,29 @@ class Corefine {
       first = last;
     }
 
-    right_triangulations_.reserve(ranges.size());
-    for (const auto& range : ranges) {
-      const auto& any_info = range.front();
-      auto fi = any_info.right_fi;
-      right_triangulations_.emplace(fi, std::nullopt);
-    }
-
     try {
-      parallel_do(ranges.begin(), ranges.end(), [&](const auto& range) {
-        const auto& any_info = range.front();
-        auto fi = any_info.right_fi;
-        const auto& f = right_.face(fi);
-        auto a = right_point_ids_.at(f[0].idx());
-        auto b = right_point_ids_.at(f[1].idx());
-        auto c = right_point_ids_.at(f[2].idx());
-        const auto& pa = points_.at(a);
-        const auto& pb = points_.at(b);
-        const auto& pc = points_.at(c);
-
-        auto& triangulation = right_triangulations_.at(any_info.right_fi)
-                                  .emplace(Triangle_region::RIGHT_FACE, pa, pb, pc, a, b, c);
-        for (const auto& info : range) {
-          insert_intersection(triangulation, info);
-        }
-      });
+      parallel_do(
+          ranges.begin(), ranges.end(), std::pair<Triangulation, Triangulated_faces>{},
+          [&](const auto& range, auto& local_state) {
+            auto& [triangulation, local_faces] = local_state;
+            const auto& any_info = range.front();
+            auto fi = any_info.right_fi;
+            const auto& f = right_.face(fi);
+            auto a = right_point_ids_.at(f[0].idx());
+            auto b = right_point_ids_.at(f[1].idx());
+            auto c = right_point_ids_.at(f[2].idx());
+            const auto& pa = points_.at(a);
+            const auto& pb = points_.at(b);
+            const auto& pc = points_.at(c);
+
+            triangulation.reset(Triangle_region::RIGHT_FACE, pa, pb, pc, a, b, c);
+            for (const auto& info : range) {
+              insert_intersection(triangulation, info);
+            }
+            auto count = triangulation.get_faces(std::back_inserter(local_faces.faces));
+            local_faces.counts.emplace_back(fi, count);
+          },
+          [&](auto& local_state) { right_faces_.append(local_state.second); });
     } catch (const typename Triangulation::Intersection_of_constraints_exception&) {
       throw std::runtime_error("the first mesh has self-intersections");
     }
@@ -227,18 +268,43 @@ class Corefine {
   template <class OutputIterator>
   std::pair<Face_tag, std::size_t> get_left_faces(Face_index fi, OutputIterator faces) const {
     auto tag = left_face_tags_.at(fi.idx());
-    auto count = get_faces(left_, fi, left_triangulations_, left_point_ids_, faces);
+    auto count = get_faces(left_, fi, left_faces_, left_point_ids_, faces);
     return {tag, count};
   }
 
   template <class OutputIterator>
   std::pair<Face_tag, std::size_t> get_right_faces(Face_index fi, OutputIterator faces) const {
     auto tag = right_face_tags_.at(fi.idx());
-    auto count = get_faces(right_, fi, right_triangulations_, right_point_ids_, faces);
+    auto count = get_faces(right_, fi, right_faces_, right_point_ids_, faces);
     return {tag, count};
   }
 
-  std::vector<Point> take_points() { return points_.take_points(); }
+  // The intersection points whose exact values have been computed by the predicates so far are
+  // flattened, and the others keep their construction DAGs until they are needed.
+  std::vector<Point> take_points() {
+    auto points = points_.take_points();
+
+    std::size_t num_exact{};
+    auto exact_known = true;
+    for (auto i = num_input_points_; i < points.size(); ++i) {
+      auto& p = points.at(i);
+      auto has_exact = internal::has_exact_value(p);
+      if (!has_exact) {
+        exact_known = false;
+        break;
+      }
+      if (*has_exact) {
+        p = internal::flatten_point(p);
+        ++num_exact;
+      }
+    }
+    if (exact_known) {
+      std::cout << "  exactly evaluated intersection points: " << num_exact << " / "
+                << points.size() - num_input_points_ << std::endl;
+    }
+
+    return points;
+  }
 
  private:
   struct Intersection_info {
@@ -248,14 +314,47 @@ class Corefine {
     boost::container::static_vector<std::size_t, 6> intersections;
   };
 
+  // The faces triangulated by a thread. The faces of each input face are consecutive.
+  struct Triangulated_faces {
+    std::vector<Face> faces;
+    std::vector<std::pair<Face_index, std::size_t>> counts;
+  };
+
+  // The faces of the triangulated input faces, stored contiguously.
+  class Face_store {
+   public:
+    void append(const Triangulated_faces& triangulated) {
+      auto first = faces_.size();
+      faces_.insert(faces_.end(), triangulated.faces.begin(), triangulated.faces.end());
+      for (auto [fi, count] : triangulated.counts) {
+        ranges_.emplace(fi, std::pair{first, count});
+        first += count;
+      }
+    }
+
+    template <class OutputIterator>
+    std::optional<std::size_t> get_faces(Face_index fi, OutputIterator faces) const {
+      auto it = ranges_.find(fi);
+      if (it == ranges_.end()) {
+        return std::nullopt;
+      }
+      auto [first, count] = it->second;
+      std::copy_n(faces_.begin() + static_cast<std::ptrdiff_t>(first), count, faces);
+      return count;
+    }
+
+   private:
+    std::vector<Face> faces_;
+    boost::unordered_flat_map<Face_index, std::pair<std::size_t, std::size_t>,
+                              std::hash<Face_index>>
+        ranges_;
+  };
+
   template <class OutputIterator>
-  std::size_t get_faces(const Triangle_soup& soup, Face_index fi,
-                        const boost::unordered_flat_map<Face_index, std::optional<Triangulation>,
-                                                        std::hash<Face_index>>& triangulations,
+  std::size_t get_faces(const Triangle_soup& soup, Face_index fi, const Face_store& face_store,
                         const std::vector<std::size_t>& point_ids, OutputIterator faces) const {
-    auto it = triangulations.find(fi);
-    if (it != triangulations.end()) {
-      return it->second.value().get_faces(faces);
+    if (auto count = face_store.get_faces(fi, faces)) {
+      return *count;
     }
 
     const auto& f = soup.face(fi);
@@ -266,39 +365,123 @@ class Corefine {
     return 1;
   }
 
+  // Constructs the intersection points in parallel. Each distinct point is constructed once,
+  // and the ids are assigned in the order of the keys, so they do not depend on the scheduling.
+  void construct_intersection_points() {
+    using Key = typename Intersection_point_inserter::Key;
+    using Slot = std::pair<std::size_t, std::size_t>;
+    using Entry = std::pair<Key, Slot>;
+
+    std::vector<Entry> entries;
+    parallel_do(
+        boost::counting_iterator<std::size_t>(0),
+        boost::counting_iterator<std::size_t>(infos_.size()), std::vector<Entry>{},
+        [&](std::size_t i, auto& local_entries) {
+          auto& info = infos_.at(i);
+          const auto& left_face = left_.face(info.left_fi);
+          const auto& right_face = right_.face(info.right_fi);
+          auto a = left_point_ids_.at(left_face[0].idx());
+          auto b = left_point_ids_.at(left_face[1].idx());
+          auto c = left_point_ids_.at(left_face[2].idx());
+          auto p = right_point_ids_.at(right_face[0].idx());
+          auto q = right_point_ids_.at(right_face[1].idx());
+          auto r = right_point_ids_.at(right_face[2].idx());
+          for (std::size_t j = 0; j < info.symbolic_intersections.size(); ++j) {
+            auto sym_inter = info.symbolic_intersections.at(j);
+            auto left_region = intersection(sym_inter, Triangle_region::LEFT_FACE);
+            auto right_region = intersection(sym_inter, Triangle_region::RIGHT_FACE);
+            Key key;
+            auto id = Intersection_point_inserter::vertex_or_key(left_region, a, b, c,
+                                                                 right_region, p, q, r, key);
+            info.intersections.push_back(id.value_or(Intersection_point_inserter::kNone));
+            if (!id) {
+              local_entries.emplace_back(key, Slot{i, j});
+            }
+          }
+        },
+        [&](auto& local_entries) {
+          if (entries.empty()) {
+            entries = std::move(local_entries);
+          } else {
+            entries.insert(entries.end(), local_entries.begin(), local_entries.end());
+          }
+        });
+
+    parallel_sort(entries.begin(), entries.end());
+
+    std::vector<Key> keys;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      const auto& [key, slot] = entries.at(i);
+      if (i == 0 || key != entries.at(i - 1).first) {
+        keys.push_back(key);
+      }
+      infos_.at(slot.first).intersections.at(slot.second) = points_.size() + keys.size() - 1;
+    }
+
+    num_input_points_ = points_.size();
+
+    Intersection_point_inserter inserter(points_);
+    std::vector<Point> new_points(keys.size());
+    parallel_do(boost::counting_iterator<std::size_t>(0),
+                boost::counting_iterator<std::size_t>(keys.size()), [&](std::size_t i) {
+                  auto& p = new_points.at(i);
+                  p = inserter.construct(keys.at(i));
+                  if constexpr (requires { p.exact(); }) {
+#if CGAL_VERSION_NR >= CGAL_VERSION_NUMBER(5, 5, 0)
+                    // The exact value is computed only if a predicate cannot be decided with the
+                    // interval approximation. Concurrent evaluation is thread-safe since CGAL 5.5.
+                    // Points that are exactly representable by doubles are flattened right away,
+                    // which does not require the exact value.
+                    const auto& approx = p.approx();
+                    if (approx.x().is_point() && approx.y().is_point() && approx.z().is_point()) {
+                      p = internal::flatten_point(p);
+                    }
+#else
+                    // Evaluate the point exactly in parallel, as the lazy evaluation is not
+                    // thread-safe, and drop its construction DAG.
+                    p.exact();
+                    p = internal::flatten_point(p);
+#endif
+                  }
+                });
+
+    points_.reserve(points_.size() + new_points.size());
+    for (auto& p : new_points) {
+      points_.insert(std::move(p));
+    }
+  }
+
   void insert_intersection(Triangulation& triangulation, const Intersection_info& info) {
-    typename Triangulation::Vertex_handle null_vh;
-    auto first = null_vh;
-    auto prev = null_vh;
+    std::optional<std::size_t> first;
+    std::optional<std::size_t> prev;
     for (std::size_t i = 0; i < info.intersections.size(); ++i) {
       auto id = info.intersections.at(i);
       auto sym = info.symbolic_intersections.at(i);
       auto cur = triangulation.insert(points_.at(id), id, sym);
-      if (prev != null_vh) {
-        triangulation.insert_constraint(prev, cur);
+      if (prev) {
+        triangulation.insert_constraint(*prev, cur);
       }
-      if (first == null_vh) {
+      if (!first) {
         first = cur;
       }
       prev = cur;
     }
     if (info.intersections.size() > 2) {
-      triangulation.insert_constraint(prev, first);
+      triangulation.insert_constraint(*prev, *first);
     }
   }
 
   const Triangle_soup& left_;
-  boost::unordered_flat_map<Face_index, std::optional<Triangulation>, std::hash<Face_index>>
-      left_triangulations_;
+  Face_store left_faces_;
   const Triangle_soup& right_;
-  boost::unordered_flat_map<Face_index, std::optional<Triangulation>, std::hash<Face_index>>
-      right_triangulations_;
+  Face_store right_faces_;
   Point_list points_;
   std::vector<std::size_t> left_point_ids_;
   std::vector<std::size_t> right_point_ids_;
   std::vector<Face_tag> left_face_tags_;
   std::vector<Face_tag> right_face_tags_;
   std::vector<Intersection_info> infos_;
+  std::size_t num_input_points_{};
 };
 
 }  // namespace kigumi
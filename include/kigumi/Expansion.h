@@ -0,0 +1,152 @@
+#pragma once
+
+#include <CGAL/enum.h>
+#include <kigumi/Point_list.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+
+namespace kigumi {
+
+namespace internal {
+
+// A sum of doubles whose bits do not overlap, stored in increasing order of magnitude, which
+// represents the sum of up to N doubles exactly (Shewchuk, 1997). The rounding mode must be
+// round-to-nearest, and the operations must not underflow or overflow.
+template <std::size_t N>
+class Expansion {
+ public:
+  // Adds x exactly.
+  void add(double x) {
+    std::size_t n{};
+    for (std::size_t i = 0; i < size_; ++i) {
+      auto sum = x + components_.at(i);
+      auto x_virtual = sum - components_.at(i);
+      auto c_virtual = sum - x_virtual;
+      auto error = (x - x_virtual) + (components_.at(i) - c_virtual);
+      x = sum;
+      if (error != 0.0) {
+        components_.at(n++) = error;
+      }
+    }
+    if (x != 0.0 || n == 0) {
+      components_.at(n++) = x;
+    }
+    size_ = n;
+  }
+
+  // Adds the product of the factors exactly.
+  template <std::size_t M>
+  void add_product(const std::array<double, M>& factors) {
+    std::array<double, std::size_t{1} << (M - 1)> terms{};
+    std::size_t num_terms = 1;
+    terms.at(0) = factors.at(0);
+    for (std::size_t i = 1; i < M; ++i) {
+      for (std::size_t j = 0; j < num_terms; ++j) {
+        auto product = terms.at(j) * factors.at(i);
+        terms.at(num_terms + j) = std::fma(terms.at(j), factors.at(i), -product);
+        terms.at(j) = product;
+      }
+      num_terms *= 2;
+    }
+    for (auto term : terms) {
+      add(term);
+    }
+  }
+
+  // The sign of the largest component, which is the sign of the sum.
+  CGAL::Sign sign() const {
+    auto x = size_ == 0 ? 0.0 : components_.at(size_ - 1);
+    return x > 0.0 ? CGAL::POSITIVE : x < 0.0 ? CGAL::NEGATIVE : CGAL::ZERO;
+  }
+
+ private:
+  std::array<double, N> components_{};
+  std::size_t size_{};
+};
+
+// Returns true if the products of up to three coordinates in the range can be computed exactly
+// with expansions.
+inline bool is_in_expansion_range(double x) {
+  return x == 0.0 || (std::abs(x) >= 0x1p-300 && std::abs(x) <= 0x1p300);
+}
+
+// Returns the sign of the determinant of the (D + 1) x (D + 1) matrix whose i-th row consists
+// of the coordinates of the i-th point followed by 1, evaluated exactly by the Leibniz formula.
+template <std::size_t D>
+CGAL::Sign lifted_determinant_sign(const std::array<std::array<double, D>, D + 1>& points) {
+  constexpr std::size_t kNumPermutations = D == 2 ? 6 : 24;
+  static_assert(D == 2 || D == 3);
+
+  Expansion<kNumPermutations * (std::size_t{1} << (D - 1))> det;
+  std::array<std::size_t, D + 1> sigma{};
+  for (std::size_t i = 0; i <= D; ++i) {
+    sigma.at(i) = i;
+  }
+
+  do {
+    auto odd = false;
+    for (std::size_t i = 0; i <= D; ++i) {
+      for (std::size_t j = i + 1; j <= D; ++j) {
+        odd ^= sigma.at(i) > sigma.at(j);
+      }
+    }
+
+    // The row whose column is that of 1 does not contribute a factor.
+    std::array<double, D> factors{};
+    std::size_t k{};
+    for (std::size_t i = 0; i <= D; ++i) {
+      if (sigma.at(i) != D) {
+        factors.at(k++) = points.at(i).at(sigma.at(i));
+      }
+    }
+    if (odd) {
+      factors.at(0) = -factors.at(0);
+    }
+    det.add_product(factors);
+  } while (std::next_permutation(sigma.begin(), sigma.end()));
+
+  return det.sign();
+}
+
+// Computes CGAL::orientation(p, q, r, s) exactly with floating-point expansions.
+// Returns std::nullopt if a coordinate is not in the range of is_in_expansion_range,
+// e.g., NaN for points that are not exactly representable by doubles.
+inline std::optional<CGAL::Orientation> expansion_orientation(const Double_point& p,
+                                                              const Double_point& q,
+                                                              const Double_point& r,
+                                                              const Double_point& s) {
+  std::array<std::array<double, 3>, 4> points{p, q, r, s};
+  for (const auto& point : points) {
+    if (!std::all_of(point.begin(), point.end(), is_in_expansion_range)) {
+      return std::nullopt;
+    }
+  }
+
+  // Subtracting the first row from the others shows that the lifted determinant is
+  // -det(q - p, r - p, s - p).
+  return -lifted_determinant_sign<3>(points);
+}
+
+// Computes the orientation of p, q, and r projected onto the coordinate plane of the axes i and j
+// exactly with floating-point expansions. Returns std::nullopt as expansion_orientation.
+inline std::optional<CGAL::Orientation> expansion_orientation_2(const Double_point& p,
+                                                                const Double_point& q,
+                                                                const Double_point& r,
+                                                                std::size_t i, std::size_t j) {
+  std::array<std::array<double, 2>, 3> points{{{p[i], p[j]}, {q[i], q[j]}, {r[i], r[j]}}};
+  for (const auto& point : points) {
+    if (!std::all_of(point.begin(), point.end(), is_in_expansion_range)) {
+      return std::nullopt;
+    }
+  }
+
+  return lifted_determinant_sign<2>(points);
+}
+
+}  // namespace internal
+
+}  // namespace kigumi
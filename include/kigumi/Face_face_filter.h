@@ -0,0 +1,309 @@
+#pragma once
+
+#include <CGAL/enum.h>
+#include <kigumi/Point_list.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#if defined(__AVX2__) || defined(__AVX512F__)
+#include <immintrin.h>
+#endif
+
+namespace kigumi {
+
+namespace internal {
+
+// Computes CGAL::orientation(p, q, r, s) in double precision.
+// Returns std::nullopt if the sign cannot be certified with the static error bound of
+// Shewchuk's orient3d, or if it is zero.
+inline std::optional<CGAL::Orientation> certified_orientation(const Double_point& p,
+                                                              const Double_point& q,
+                                                              const Double_point& r,
+                                                              const Double_point& s) {
+  constexpr double kEpsilon = 0x1p-53;
+  constexpr double kErrorBound = (7.0 + 56.0 * kEpsilon) * kEpsilon;
+
+  auto adx = q[0] - p[0];
+  auto bdx = r[0] - p[0];
+  auto cdx = s[0] - p[0];
+  auto ady = q[1] - p[1];
+  auto bdy = r[1] - p[1];
+  auto cdy = s[1] - p[1];
+  auto adz = q[2] - p[2];
+  auto bdz = r[2] - p[2];
+  auto cdz = s[2] - p[2];
+
+  auto bdxcdy = bdx * cdy;
+  auto cdxbdy = cdx * bdy;
+  auto cdxady = cdx * ady;
+  auto adxcdy = adx * cdy;
+  auto adxbdy = adx * bdy;
+  auto bdxady = bdx * ady;
+
+  auto det = adz * (bdxcdy - cdxbdy) + bdz * (cdxady - adxcdy) + cdz * (adxbdy - bdxady);
+  auto permanent = (std::abs(bdxcdy) + std::abs(cdxbdy)) * std::abs(adz) +
+                   (std::abs(cdxady) + std::abs(adxcdy)) * std::abs(bdz) +
+                   (std::abs(adxbdy) + std::abs(bdxady)) * std::abs(cdz);
+  auto error_bound = kErrorBound * permanent;
+
+  if (det > error_bound) {
+    return CGAL::POSITIVE;
+  }
+  if (-det > error_bound) {
+    return CGAL::NEGATIVE;
+  }
+  return std::nullopt;
+}
+
+// Computes the orientation of p, q, and r projected onto the coordinate plane of the axes i and j
+// in double precision. Returns std::nullopt if the sign cannot be certified with the static
+// error bound of Shewchuk's orient2d, or if it is zero.
+inline std::optional<CGAL::Orientation> certified_orientation_2(const Double_point& p,
+                                                                const Double_point& q,
+                                                                const Double_point& r,
+                                                                std::size_t i, std::size_t j) {
+  constexpr double kEpsilon = 0x1p-53;
+  constexpr double kErrorBound = (3.0 + 16.0 * kEpsilon) * kEpsilon;
+
+  auto left = (q[i] - p[i]) * (r[j] - p[j]);
+  auto right = (q[j] - p[j]) * (r[i] - p[i]);
+  auto det = left - right;
+  auto error_bound = kErrorBound * (std::abs(left) + std::abs(right));
+
+  if (det > error_bound) {
+    return CGAL::POSITIVE;
+  }
+  if (-det > error_bound) {
+    return CGAL::NEGATIVE;
+  }
+  return std::nullopt;
+}
+
+// A batch of the predicates orientation(p, q, r, s) in the structure-of-arrays layout.
+class Orientation_3_batch {
+ public:
+  void clear() {
+    for (auto& coords : coords_) {
+      coords.clear();
+    }
+  }
+
+  void push_back(const Double_point& p, const Double_point& q, const Double_point& r,
+                 const Double_point& s) {
+    for (std::size_t i = 0; i < 3; ++i) {
+      coords_.at(i).push_back(p.at(i));
+      coords_.at(3 + i).push_back(q.at(i));
+      coords_.at(6 + i).push_back(r.at(i));
+      coords_.at(9 + i).push_back(s.at(i));
+    }
+  }
+
+  std::size_t size() const { return coords_.front().size(); }
+
+  // Returns the coordinates along the axis of the point-th points (p, q, r, or s).
+  const double* data(std::size_t point, std::size_t axis) const {
+    return coords_.at(3 * point + axis).data();
+  }
+
+  Double_point at(std::size_t point, std::size_t i) const {
+    return {data(point, 0)[i], data(point, 1)[i], data(point, 2)[i]};
+  }
+
+ private:
+  std::array<std::vector<double>, 12> coords_;
+};
+
+#if defined(__AVX512F__)
+
+struct Simd_ops {
+  using Vec = __m512d;
+  static constexpr std::size_t kLanes = 8;
+  static Vec load(const double* p) { return _mm512_loadu_pd(p); }
+  static Vec set1(double x) { return _mm512_set1_pd(x); }
+  static Vec add(Vec a, Vec b) { return _mm512_add_pd(a, b); }
+  static Vec sub(Vec a, Vec b) { return _mm512_sub_pd(a, b); }
+  static Vec mul(Vec a, Vec b) { return _mm512_mul_pd(a, b); }
+  static Vec abs(Vec a) { return _mm512_abs_pd(a); }
+  static unsigned greater(Vec a, Vec b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+};
+
+#elif defined(__AVX2__)
+
+struct Simd_ops {
+  using Vec = __m256d;
+  static constexpr std::size_t kLanes = 4;
+  static Vec load(const double* p) { return _mm256_loadu_pd(p); }
+  static Vec set1(double x) { return _mm256_set1_pd(x); }
+  static Vec add(Vec a, Vec b) { return _mm256_add_pd(a, b); }
+  static Vec sub(Vec a, Vec b) { return _mm256_sub_pd(a, b); }
+  static Vec mul(Vec a, Vec b) { return _mm256_mul_pd(a, b); }
+  static Vec abs(Vec a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+  static unsigned greater(Vec a, Vec b) {
+    return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(a, b, _CMP_GT_OQ)));
+  }
+};
+
+#endif
+
+// Evaluates the predicates of the batch as certified_orientation does, and stores the signs
+// (1, -1, or 0 if uncertain) into signs. The predicates are evaluated with AVX-512 or AVX2
+// if enabled at compile time.
+inline void certified_orientations(const Orientation_3_batch& batch,
+                                   std::vector<std::int8_t>& signs) {
+  auto n = batch.size();
+  signs.resize(n);
+
+  std::size_t i{};
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+  using Ops = Simd_ops;
+  constexpr double kEpsilon = 0x1p-53;
+  constexpr double kErrorBound = (7.0 + 56.0 * kEpsilon) * kEpsilon;
+
+  auto error_bound_factor = Ops::set1(kErrorBound);
+  auto zero = Ops::set1(0.0);
+
+  for (; i + Ops::kLanes <= n; i += Ops::kLanes) {
+    auto px = Ops::load(batch.data(0, 0) + i);
+    auto py = Ops::load(batch.data(0, 1) + i);
+    auto pz = Ops::load(batch.data(0, 2) + i);
+
+    auto adx = Ops::sub(Ops::load(batch.data(1, 0) + i), px);
+    auto ady = Ops::sub(Ops::load(batch.data(1, 1) + i), py);
+    auto adz = Ops::sub(Ops::load(batch.data(1, 2) + i), pz);
+    auto bdx = Ops::sub(Ops::load(batch.data(2, 0) + i), px);
+    auto bdy = Ops::sub(Ops::load(batch.data(2, 1) + i), py);
+    auto bdz = Ops::sub(Ops::load(batch.data(2, 2) + i), pz);
+    auto cdx = Ops::sub(Ops::load(batch.data(3, 0) + i), px);
+    auto cdy = Ops::sub(Ops::load(batch.data(3, 1) + i), py);
+    auto cdz = Ops::sub(Ops::load(batch.data(3, 2) + i), pz);
+
+    auto bdxcdy = Ops::mul(bdx, cdy);
+    auto cdxbdy = Ops::mul(cdx, bdy);
+    auto cdxady = Ops::mul(cdx, ady);
+    auto adxcdy = Ops::mul(adx, cdy);
+    auto adxbdy = Ops::mul(adx, bdy);
+    auto bdxady = Ops::mul(bdx, ady);
+
+    auto det = Ops::add(Ops::add(Ops::mul(adz, Ops::sub(bdxcdy, cdxbdy)),
+                                 Ops::mul(bdz, Ops::sub(cdxady, adxcdy))),
+                        Ops::mul(cdz, Ops::sub(adxbdy, bdxady)));
+    auto permanent =
+        Ops::add(Ops::add(Ops::mul(Ops::add(Ops::abs(bdxcdy), Ops::abs(cdxbdy)), Ops::abs(adz)),
+                          Ops::mul(Ops::add(Ops::abs(cdxady), Ops::abs(adxcdy)), Ops::abs(bdz))),
+                 Ops::mul(Ops::add(Ops::abs(adxbdy), Ops::abs(bdxady)), Ops::abs(cdz)));
+    auto error_bound = Ops::mul(error_bound_factor, permanent);
+
+    auto positive = Ops::greater(det, error_bound);
+    auto negative = Ops::greater(Ops::sub(zero, det), error_bound);
+    for (std::size_t lane = 0; lane < Ops::kLanes; ++lane) {
+      auto bit = 1U << lane;
+      signs.at(i + lane) = (positive & bit) != 0 ? 1 : (negative & bit) != 0 ? -1 : 0;
+    }
+  }
+#endif
+
+  for (; i < n; ++i) {
+    auto o = certified_orientation(batch.at(0, i), batch.at(1, i), batch.at(2, i), batch.at(3, i));
+    signs.at(i) = static_cast<std::int8_t>(o.value_or(CGAL::ZERO));
+  }
+}
+
+}  // namespace internal
+
+// A floating-point filter that cheaply rejects pairs of faces that cannot intersect.
+//
+// The faces are rejected if the vertices of either face lie strictly on one side of the
+// supporting plane of the other face, which is decided with a certified static filter.
+// Faces with vertices that are not exactly representable by doubles are never rejected.
+template <class K>
+class Face_face_filter {
+  using Double_point = internal::Double_point;
+  using Point_list = Point_list<K>;
+
+ public:
+  // The ids of the vertices of two faces abc and pqr.
+  using Face_pair = std::array<std::size_t, 6>;
+  // The certified signs of orientation(p, q, r, x) for x = a, b, c and orientation(a, b, c, x)
+  // for x = p, q, r, where 0 means uncertain.
+  using Signs = std::array<std::int8_t, 6>;
+
+  explicit Face_face_filter(const Point_list& points) : points_(points) {}
+
+  // Evaluates the predicates of a batch of pairs at once.
+  void operator()(const std::vector<Face_pair>& pairs, std::vector<Signs>& signs) const {
+    thread_local internal::Orientation_3_batch batch;
+    thread_local std::vector<std::int8_t> batch_signs;
+
+    // The NaN coordinates of inexact points make the predicates that involve them uncertain.
+    batch.clear();
+    for (const auto& ids : pairs) {
+      const auto& a = points_.double_point(ids[0]);
+      const auto& b = points_.double_point(ids[1]);
+      const auto& c = points_.double_point(ids[2]);
+      const auto& p = points_.double_point(ids[3]);
+      const auto& q = points_.double_point(ids[4]);
+      const auto& r = points_.double_point(ids[5]);
+      batch.push_back(p, q, r, a);
+      batch.push_back(p, q, r, b);
+      batch.push_back(p, q, r, c);
+      batch.push_back(a, b, c, p);
+      batch.push_back(a, b, c, q);
+      batch.push_back(a, b, c, r);
+    }
+
+    internal::certified_orientations(batch, batch_signs);
+
+    signs.resize(pairs.size());
+    for (std::size_t i = 0; i < pairs.size(); ++i) {
+      std::copy_n(batch_signs.begin() + static_cast<std::ptrdiff_t>(6 * i), 6,
+                  signs.at(i).begin());
+    }
+  }
+
+  // Returns true if the signs show that the faces certainly do not intersect.
+  static bool is_separated(const Signs& signs) {
+    return (signs[0] != 0 && signs[0] == signs[1] && signs[1] == signs[2]) ||
+           (signs[3] != 0 && signs[3] == signs[4] && signs[4] == signs[5]);
+  }
+
+  // Returns true if the faces abc and pqr certainly do not intersect.
+  bool operator()(std::size_t a, std::size_t b, std::size_t c, std::size_t p, std::size_t q,
+                  std::size_t r) const {
+    if (!points_.is_double_point(a) || !points_.is_double_point(b) ||
+        !points_.is_double_point(c) || !points_.is_double_point(p) ||
+        !points_.is_double_point(q) || !points_.is_double_point(r)) {
+      return false;
+    }
+
+    std::array abc{points_.double_point(a), points_.double_point(b), points_.double_point(c)};
+    std::array pqr{points_.double_point(p), points_.double_point(q), points_.double_point(r)};
+
+    return is_strictly_on_one_side(pqr, abc) || is_strictly_on_one_side(abc, pqr);
+  }
+
+ private:
+  // Returns true if all of the points certainly lie on the same side of the plane.
+  static bool is_strictly_on_one_side(const std::array<Double_point, 3>& points,
+                                      const std::array<Double_point, 3>& plane) {
+    auto o0 = internal::certified_orientation(plane[0], plane[1], plane[2], points[0]);
+    if (!o0) {
+      return false;
+    }
+    auto o1 = internal::certified_orientation(plane[0], plane[1], plane[2], points[1]);
+    if (!o1 || *o1 != *o0) {
+      return false;
+    }
+    auto o2 = internal::certified_orientation(plane[0], plane[1], plane[2], points[2]);
+    return o2 && *o2 == *o0;
+  }
+
+  const Point_list& points_;
+};
+
+}  // namespace kigumi
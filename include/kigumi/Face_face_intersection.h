@@ -2,6 +2,8 @@
 
 #include <CGAL/Kernel/global_functions.h>
 #include <CGAL/enum.h>
+#include <kigumi/Expansion.h>
+#include <kigumi/Face_face_filter.h>
 #include <kigumi/Point_list.h>
 #include <kigumi/Triangle_region.h>
 
@@ -9,29 +11,107 @@
 #include <array>
 #include <boost/container/static_vector.hpp>
 #include <boost/container_hash/hash.hpp>
-#include <boost/unordered/unordered_flat_map.hpp>
+#include <cstddef>
+#include <initializer_list>
+#include <limits>
+#include <optional>
 #include <utility>
 #include <vector>
 
 namespace kigumi {
 
+// The results of the orientation predicates are cached across calls, so that the predicates
+// shared by nearby pairs of faces are evaluated only once. The cache is direct-mapped and has
+// a fixed size; an entry is overwritten when another key maps to the same slot.
+// Each thread should use its own instance.
 template <class K>
 class Face_face_intersection {
+  using Orientation_2_key = std::array<std::size_t, 3>;
   using Orientation_3_key = std::array<std::size_t, 4>;
   using Orientation_3_key_hash = boost::hash<Orientation_3_key>;
-  using Orientation_3_map =
-      boost::unordered_flat_map<Orientation_3_key, CGAL::Orientation, Orientation_3_key_hash>;
   using Point_list = Point_list<K>;
 
+  static constexpr std::size_t kNone = std::numeric_limits<std::size_t>::max();
+  static constexpr std::size_t kOrientation3CacheSize = std::size_t{1} << 12;
+  // The number of the triples of the vertices of a pair of faces.
+  static constexpr std::size_t kOrientation2CacheSize = 20;
+
+  struct Orientation_3_cache_entry {
+    Orientation_3_key key{kNone, kNone, kNone, kNone};
+    CGAL::Orientation orientation{CGAL::ZERO};
+  };
+
  public:
-  explicit Face_face_intersection(const Point_list& points) : points_(points) {}
+  explicit Face_face_intersection(const Point_list& points)
+      : points_(points), orientation_3_cache_(kOrientation3CacheSize) {}
+
+  std::size_t num_cache_hits() const { return num_cache_hits_; }
+
+  std::size_t num_cache_misses() const { return num_cache_misses_; }
+
+  // Stores the result of CGAL::orientation(a, b, c, d) known in advance, e.g., certified by
+  // Face_face_filter, so that it is not evaluated again.
+  void cache_orientation(std::size_t a, std::size_t b, std::size_t c, std::size_t d,
+                         CGAL::Orientation o) const {
+    Orientation_3_key key{a, b, c, d};
+    auto parity = sort(key);
+    auto& entry = cache_entry(key);
+    entry.key = key;
+    entry.orientation = parity * o;
+  }
+
+  // Returns true if the non-degenerate faces abc and pqr share one or two vertices and are
+  // known to intersect only at the shared vertex or the shared edge. This is decided from a few
+  // orientations without computing the intersection. If false is returned, the intersection
+  // must be computed with operator().
+  bool touches_only_at_shared_vertices(std::size_t a, std::size_t b, std::size_t c,
+                                       std::size_t p, std::size_t q, std::size_t r) const {
+    orientation_2_cache_.clear();
+    dropped_axis_cache_.clear();
+
+    // Move the shared vertices to the front.
+    std::array<std::size_t, 3> abc{a, b, c};
+    std::array<std::size_t, 3> pqr{p, q, r};
+    std::size_t num_shared{};
+    for (std::size_t i = 0; i < 3; ++i) {
+      auto it = std::find(pqr.begin() + num_shared, pqr.end(), abc.at(i));
+      if (it != pqr.end()) {
+        std::swap(abc.at(num_shared), abc.at(i));
+        std::iter_swap(pqr.begin() + num_shared, it);
+        ++num_shared;
+      }
+    }
+    auto [u, v, w] = abc;
+    auto [x, y, z] = pqr;
+
+    if (num_shared == 1) {
+      // The faces meet only at u if the other vertices of either face are strictly on the same
+      // side of the plane of the other face.
+      if (orientation(u, v, w, y) * orientation(u, v, w, z) == CGAL::POSITIVE) {
+        return true;
+      }
+      return orientation(x, y, z, v) * orientation(x, y, z, w) == CGAL::POSITIVE;
+    }
+
+    if (num_shared == 2) {
+      // The planes of the faces meet at the line of the shared edge unless they are the same.
+      if (orientation(u, v, w, z) != CGAL::ZERO) {
+        return true;
+      }
+      dropped_axis_ = dropped_axis(u, v, w);
+      return orientation(u, v, w) * orientation(u, v, z) == CGAL::NEGATIVE;
+    }
+
+    return false;
+  }
 
   boost::container::static_vector<Triangle_region, 6> operator()(std::size_t a, std::size_t b,
                                                                  std::size_t c, std::size_t p,
                                                                  std::size_t q,
                                                                  std::size_t r) const {
     intersections_.clear();
-    orientation_3_cache_.clear();
+    orientation_2_cache_.clear();
+    dropped_axis_cache_.clear();
 
     auto fabc = Triangle_region::LEFT_FACE;
     auto fpqr = Triangle_region::RIGHT_FACE;
@@ -178,6 +258,8 @@ class Face_face_intersection {
                                  std::size_t r) const {
     auto [va, vb] = edge_vertices(eab);
 
+    dropped_axis_ = dropped_axis(p, q, r);
+
     auto apq = orientation(a, p, q);
     auto aqr = orientation(a, q, r);
     auto arp = orientation(a, r, p);
@@ -308,29 +390,127 @@ class Face_face_intersection {
     return CGAL::compare_lexicographically(pa, pb);
   }
 
+  // Computes CGAL::coplanar_orientation(a, b, c) for the points on the plane of the face whose
+  // dropped axis is set to dropped_axis_. The results are cached during a call of operator().
   CGAL::Orientation orientation(std::size_t a, std::size_t b, std::size_t c) const {
-    const auto& pa = points_.at(a);
-    const auto& pb = points_.at(b);
-    const auto& pc = points_.at(c);
-    return CGAL::coplanar_orientation(pa, pb, pc);
+    Orientation_2_key key{a, b, c};
+    auto parity = sort(key);
+    if (key[0] == key[1] || key[1] == key[2]) {
+      return CGAL::ZERO;
+    }
+    for (const auto& [k, o] : orientation_2_cache_) {
+      if (k == key) {
+        return parity * o;
+      }
+    }
+
+    CGAL::Orientation o{CGAL::ZERO};
+    if (dropped_axis_) {
+      o = projected_orientation(key[0], key[1], key[2], *dropped_axis_);
+    } else {
+      for (std::size_t axis : {2, 0, 1}) {
+        o = projected_orientation(key[0], key[1], key[2], axis);
+        if (o != CGAL::ZERO) {
+          break;
+        }
+      }
+    }
+    if (orientation_2_cache_.size() < kOrientation2CacheSize) {
+      orientation_2_cache_.emplace_back(key, o);
+    }
+    return parity * o;
+  }
+
+  // CGAL::coplanar_orientation projects the points onto the first of the xy, yz, and xz planes
+  // (dropping the axis 2, 0, and 1, respectively) in which they are not collinear. For the points
+  // on a plane, the projection is the same as the one for any non-collinear points on the plane,
+  // so it is determined once from the face. Returns std::nullopt if the face is degenerate.
+  std::optional<std::size_t> dropped_axis(std::size_t p, std::size_t q, std::size_t r) const {
+    Orientation_2_key key{p, q, r};
+    sort(key);
+    for (const auto& [k, axis] : dropped_axis_cache_) {
+      if (k == key) {
+        return axis;
+      }
+    }
+
+    std::optional<std::size_t> result;
+    for (std::size_t axis : {2, 0, 1}) {
+      if (projected_orientation(p, q, r, axis) != CGAL::ZERO) {
+        result = axis;
+        break;
+      }
+    }
+    dropped_axis_cache_.emplace_back(key, result);
+    return result;
+  }
+
+  CGAL::Orientation projected_orientation(std::size_t a, std::size_t b, std::size_t c,
+                                          std::size_t dropped_axis) const {
+    std::size_t i = dropped_axis == 0 ? 1 : 0;
+    std::size_t j = dropped_axis == 2 ? 1 : 2;
+
+    const auto& da = points_.double_point(a);
+    const auto& db = points_.double_point(b);
+    const auto& dc = points_.double_point(c);
+    if (auto o = internal::certified_orientation_2(da, db, dc, i, j)) {
+      return *o;
+    }
+    if (auto o = internal::expansion_orientation_2(da, db, dc, i, j)) {
+      return *o;
+    }
+
+    using Point_2 = typename K::Point_2;
+    auto project = [&](const auto& p) {
+      return Point_2{p.cartesian(static_cast<int>(i)), p.cartesian(static_cast<int>(j))};
+    };
+    return CGAL::orientation(project(points_.at(a)), project(points_.at(b)),
+                             project(points_.at(c)));
   }
 
   CGAL::Orientation orientation(std::size_t a, std::size_t b, std::size_t c, std::size_t d) const {
     Orientation_3_key key{a, b, c, d};
     auto parity = sort(key);
-    auto [it, inserted] = orientation_3_cache_.emplace(key, CGAL::ZERO);
-
-    if (inserted) {
-      const auto& pa = points_.at(key[0]);
-      const auto& pb = points_.at(key[1]);
-      const auto& pc = points_.at(key[2]);
-      const auto& pd = points_.at(key[3]);
+    // The predicates on the faces that share vertices have repeated points.
+    if (key[0] == key[1] || key[1] == key[2] || key[2] == key[3]) {
+      return CGAL::ZERO;
+    }
+    auto& entry = cache_entry(key);
 
-      auto o = CGAL::orientation(pa, pb, pc, pd);
-      it->second = o;
+    if (entry.key == key) {
+      ++num_cache_hits_;
+    } else {
+      ++num_cache_misses_;
+
+      entry.key = key;
+
+      // Points that are not exactly representable by doubles have NaN coordinates, for which
+      // the sign is never certified. Otherwise, the sign is computed exactly with floating-point
+      // expansions.
+      const auto& da = points_.double_point(key[0]);
+      const auto& db = points_.double_point(key[1]);
+      const auto& dc = points_.double_point(key[2]);
+      const auto& dd = points_.double_point(key[3]);
+      auto o = internal::certified_orientation(da, db, dc, dd);
+      if (!o) {
+        o = internal::expansion_orientation(da, db, dc, dd);
+      }
+      if (o) {
+        entry.orientation = *o;
+      } else {
+        const auto& pa = points_.at(key[0]);
+        const auto& pb = points_.at(key[1]);
+        const auto& pc = points_.at(key[2]);
+        const auto& pd = points_.at(key[3]);
+        entry.orientation = CGAL::orientation(pa, pb, pc, pd);
+      }
     }
 
-    return parity * it->second;
+    return parity * entry.orientation;
+  }
+
+  Orientation_3_cache_entry& cache_entry(const Orientation_3_key& key) const {
+    return orientation_3_cache_.at(Orientation_3_key_hash{}(key) & (kOrientation3CacheSize - 1));
   }
 
   void insert(Triangle_region first, Triangle_region second) const {
@@ -343,7 +523,16 @@ class Face_face_intersection {
 
   const Point_list& points_;
   mutable std::vector<std::pair<Triangle_region, Triangle_region>> intersections_;
-  mutable Orientation_3_map orientation_3_cache_;
+  mutable std::optional<std::size_t> dropped_axis_;
+  mutable boost::container::static_vector<std::pair<Orientation_2_key, std::optional<std::size_t>>,
+                                          2>
+      dropped_axis_cache_;
+  mutable boost::container::static_vector<std::pair<Orientation_2_key, CGAL::Orientation>,
+                                          kOrientation2CacheSize>
+      orientation_2_cache_;
+  mutable std::vector<Orientation_3_cache_entry> orientation_3_cache_;
+  mutable std::size_t num_cache_hits_{};
+  mutable std::size_t num_cache_misses_{};
 };
 
 }  // namespace kigumi
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <CGAL/Bbox_3.h>
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Triangle_soup.h>
+#include <kigumi/mesh_utility.h>
+
+#include <limits>
+#include <numeric>
+#include <vector>
+
+namespace kigumi {
+
+struct Connected_components {
+  // The index of the component each face belongs to.
+  std::vector<std::size_t> face_components;
+  // The bounding box of each component.
+  std::vector<CGAL::Bbox_3> bboxes;
+
+  std::size_t size() const { return bboxes.size(); }
+};
+
+// Finds the connected components of a triangle soup, where faces that share a vertex are
+// connected. Vertices with the same position but different indices are not identified.
+template <class K, class FaceData>
+class Find_connected_components {
+  using Triangle_soup = Triangle_soup<K, FaceData>;
+
+ public:
+  Connected_components operator()(const Triangle_soup& m) const {
+    std::vector<std::size_t> parents(m.num_vertices());
+    std::iota(parents.begin(), parents.end(), std::size_t{0});
+
+    for (auto fi : m.faces()) {
+      const auto& f = m.face(fi);
+      unite(parents, f[0].idx(), f[1].idx());
+      unite(parents, f[0].idx(), f[2].idx());
+    }
+
+    Connected_components components;
+    components.face_components.reserve(m.num_faces());
+
+    std::vector<std::size_t> root_components(m.num_vertices(), kNone);
+    for (auto fi : m.faces()) {
+      auto root = find(parents, m.face(fi)[0].idx());
+      auto& c = root_components.at(root);
+      if (c == kNone) {
+        c = components.bboxes.size();
+        components.bboxes.emplace_back();
+      }
+      components.face_components.push_back(c);
+      components.bboxes.at(c) += internal::face_bbox(m, fi);
+    }
+
+    return components;
+  }
+
+ private:
+  static constexpr std::size_t kNone = std::numeric_limits<std::size_t>::max();
+
+  static std::size_t find(std::vector<std::size_t>& parents, std::size_t i) {
+    while (parents.at(i) != i) {
+      parents.at(i) = parents.at(parents.at(i));
+      i = parents.at(i);
+    }
+    return i;
+  }
+
+  static void unite(std::vector<std::size_t>& parents, std::size_t i, std::size_t j) {
+    i = find(parents, i);
+    j = find(parents, j);
+    if (i < j) {
+      parents.at(j) = i;
+    } else if (j < i) {
+      parents.at(i) = j;
+    }
+  }
+};
+
+}  // namespace kigumi
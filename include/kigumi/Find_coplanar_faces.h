@@ -8,7 +8,7 @@
 #include <algorithm>
 #include <array>
 #include <boost/container_hash/hash.hpp>
-#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/concurrent_flat_map.hpp>
 #include <utility>
 #include <vector>
 
@@ -36,29 +36,31 @@ class Find_coplanar_faces {
     auto& a_face_tags = left_is_a ? left_face_tags : right_face_tags;
     auto& b_face_tags = left_is_a ? right_face_tags : left_face_tags;
 
-    boost::unordered_flat_map<Triangle, Face_index, Triangle_hash> triangle_to_fi;
+    boost::concurrent_flat_map<Triangle, Face_index, Triangle_hash> triangle_to_fi;
 
+    // Of the faces with the same vertices, the first one is kept regardless of the scheduling.
     triangle_to_fi.reserve(a.num_faces());
-    for (auto fi : a.faces()) {
+    parallel_do(a.faces().begin(), a.faces().end(), [&](Face_index fi) {
       auto tri = triangle(a, fi, a_points);
-      triangle_to_fi.emplace(tri, fi);
-    }
+      triangle_to_fi.emplace_or_visit(tri, fi,
+                                      [fi](auto& x) { x.second = std::min(x.second, fi); });
+    });
 
     parallel_do(b.faces().begin(), b.faces().end(), [&](Face_index fi) {
       auto tri = triangle(b, fi, b_points);
 
-      auto it = triangle_to_fi.find(tri);
-      if (it != triangle_to_fi.end()) {
-        a_face_tags.at(it->second.idx()) = Face_tag::COPLANAR;
+      auto found = triangle_to_fi.cvisit(tri, [&](const auto& x) {
+        a_face_tags.at(x.second.idx()) = Face_tag::COPLANAR;
         b_face_tags.at(fi.idx()) = Face_tag::COPLANAR;
+      });
+      if (found != 0) {
         return;
       }
 
-      it = triangle_to_fi.find(opposite(tri));
-      if (it != triangle_to_fi.end()) {
-        a_face_tags.at(it->second.idx()) = Face_tag::OPPOSITE;
+      triangle_to_fi.cvisit(opposite(tri), [&](const auto& x) {
+        a_face_tags.at(x.second.idx()) = Face_tag::OPPOSITE;
         b_face_tags.at(fi.idx()) = Face_tag::OPPOSITE;
-      }
+      });
     });
 
     return {std::move(left_face_tags), std::move(right_face_tags)};
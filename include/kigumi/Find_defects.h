@@ -1,6 +1,8 @@
 #pragma once
 
+#include <CGAL/Kernel/global_functions.h>
 #include <kigumi/Dense_undirected_graph.h>
+#include <kigumi/Face_face_filter.h>
 #include <kigumi/Face_face_intersection.h>
 #include <kigumi/Mesh_entities.h>
 #include <kigumi/Mesh_indices.h>
@@ -23,6 +25,8 @@ namespace kigumi {
 
 template <class K, class FaceData>
 class Find_defects {
+  using Face_face_intersection = Face_face_intersection<K>;
+  using Point = typename K::Point_3;
   using Point_list = Point_list<K>;
   using Triangle_soup = Triangle_soup<K, FaceData>;
   using Leaf = typename Triangle_soup::Leaf;
@@ -72,15 +76,19 @@ class Find_defects {
     std::vector<Vertex_index> vi_map;
     vi_map.reserve(m.num_vertices());
 
-    Point_list points;
-    points.start_uniqueness_check();
+    std::vector<const Point*> input_points;
+    input_points.reserve(m.num_vertices());
     for (auto vi : m.vertices()) {
-      const auto& p = m.point(vi);
-      auto next_idx = points.size();
-      auto idx = points.insert(p);
+      input_points.push_back(&m.point(vi));
+    }
+
+    Point_list points;
+    auto ids = points.insert_unique(input_points);
+    for (std::size_t i = 0; i < ids.size(); ++i) {
+      auto idx = ids.at(i);
       vi_map.push_back(Vertex_index{idx});
-      if (idx == next_idx) {
-        new_m.add_vertex(p);
+      if (idx == new_m.num_vertices()) {
+        new_m.add_vertex(m.point(Vertex_index{i}));
       }
     }
 
@@ -265,8 +273,9 @@ class Find_defects {
           if (f[0] == f[1] || f[1] == f[2] || f[2] == f[0]) {
             return;
           }
-          auto tri = m.triangle(fi);
-          if (tri.is_degenerate()) {
+          // Equivalent to m.triangle(fi).is_degenerate(), but borrows the points instead of
+          // copying their handles into a new triangle.
+          if (CGAL::collinear(m.point(f[0]), m.point(f[1]), m.point(f[2]))) {
             local_fis.push_back(fi);
           }
         },
@@ -298,11 +307,14 @@ class Find_defects {
     }
 
     const auto& tree = m.aabb_tree();
+    Face_face_filter face_face_filter{points};
 
     parallel_do(
-        m.faces_begin(), m.faces_end(), std::vector<Face_index>{},
-        [&](auto fi, auto& local_fis) {
-          thread_local Face_face_intersection face_face_intersection{points};
+        m.faces_begin(), m.faces_end(),
+        std::pair<Face_face_intersection, std::vector<Face_index>>{Face_face_intersection{points},
+                                                                   {}},
+        [&](auto fi, auto& local_state) {
+          auto& [face_face_intersection, local_fis] = local_state;
           thread_local std::vector<const Leaf*> leaves;
           thread_local std::vector<Vertex_index> shared_vertices;
 
@@ -325,9 +337,8 @@ class Find_defects {
             auto f2 = m.face(fi2);
             std::sort(f2.begin(), f2.end());
 
-            auto inter = face_face_intersection(f[0].idx(), f[1].idx(), f[2].idx(), f2[0].idx(),
-                                                f2[1].idx(), f2[2].idx());
-            if (inter.empty()) {
+            if (face_face_filter(f[0].idx(), f[1].idx(), f[2].idx(), f2[0].idx(), f2[1].idx(),
+                                 f2[2].idx())) {
               continue;
             }
 
@@ -336,6 +347,19 @@ class Find_defects {
                                   std::back_inserter(shared_vertices));
             auto num_shared_vertices = shared_vertices.size();
 
+            // Most of the pairs of adjacent faces only touch at the shared vertices.
+            if (num_shared_vertices > 0 &&
+                face_face_intersection.touches_only_at_shared_vertices(
+                    f[0].idx(), f[1].idx(), f[2].idx(), f2[0].idx(), f2[1].idx(), f2[2].idx())) {
+              continue;
+            }
+
+            auto inter = face_face_intersection(f[0].idx(), f[1].idx(), f[2].idx(), f2[0].idx(),
+                                                f2[1].idx(), f2[2].idx());
+            if (inter.empty()) {
+              continue;
+            }
+
             if (inter.size() == 1) {
               if (num_shared_vertices < 1) {
                 local_fis.push_back(fi);
@@ -352,7 +376,8 @@ class Find_defects {
             }
           }
         },
-        [&](auto& local_fis) {
+        [&](auto& local_state) {
+          auto& local_fis = local_state.second;
           if (fis.empty()) {
             fis = std::move(local_fis);
           } else {
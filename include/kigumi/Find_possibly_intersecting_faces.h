@@ -1,20 +1,52 @@
 #pragma once
 
+#include <CGAL/Bbox_3.h>
+#include <kigumi/AABB_tree/AABB_leaf.h>
+#include <kigumi/AABB_tree/AABB_tree.h>
 #include <kigumi/Face_tag.h>
+#include <kigumi/Find_connected_components.h>
 #include <kigumi/Mesh_indices.h>
 #include <kigumi/Triangle_soup.h>
+#include <kigumi/Uniform_grid.h>
+#include <kigumi/boolean_options.h>
 #include <kigumi/mesh_utility.h>
 #include <kigumi/parallel_do.h>
+#include <kigumi/threading.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <iterator>
+#include <limits>
 #include <utility>
 #include <vector>
 
 namespace kigumi {
 
+// The decisions made for the broad phase of a pair of meshes.
+struct Broad_phase_plan {
+  // The strategy that was used. Never AUTOMATIC.
+  Broad_phase_strategy strategy{Broad_phase_strategy::AABB_TREE};
+  std::size_t num_left_components{};
+  std::size_t num_right_components{};
+  // The number of pairs of components whose bounding boxes overlap.
+  std::size_t num_component_pairs{};
+  // Whether the index was built over the faces of the left mesh.
+  bool index_left{};
+  std::size_t num_index_faces{};
+  std::size_t num_query_faces{};
+  // The number of pairs estimated from the bounding box statistics.
+  double model_num_pairs{};
+  // The number of pairs extrapolated from a sample of queries.
+  double sampled_num_pairs{};
+  std::size_t num_threads{Threading_context::current().num_threads()};
+};
+
 template <class K, class FaceData>
 class Find_possibly_intersecting_faces {
+  using Bbox = CGAL::Bbox_3;
   using Face_index_pair = std::pair<Face_index, Face_index>;
+  using Find_connected_components = Find_connected_components<K, FaceData>;
   using Triangle_soup = Triangle_soup<K, FaceData>;
   using Leaf = typename Triangle_soup::Leaf;
 
@@ -24,47 +56,378 @@ class Find_possibly_intersecting_faces {
                                           const std::vector<Face_tag>& right_face_tags) const {
     std::vector<Face_index_pair> pairs;
 
-    auto left_is_a = left.num_faces() < right.num_faces();
-    const auto& a = left_is_a ? left : right;
-    const auto& b = left_is_a ? right : left;
-    const auto& a_face_tags = left_is_a ? left_face_tags : right_face_tags;
-    const auto& b_face_tags = left_is_a ? right_face_tags : left_face_tags;
-    const auto& a_tree = a.aabb_tree();
+    (*this)(
+        left, right, left_face_tags, right_face_tags, std::vector<Face_index_pair>{},
+        [](const auto& query_pairs, auto& local_pairs) {
+          local_pairs.insert(local_pairs.end(), query_pairs.begin(), query_pairs.end());
+        },
+        [&](auto& local_pairs) {
+          if (pairs.empty()) {
+            pairs = std::move(local_pairs);
+          } else {
+            pairs.insert(pairs.end(), local_pairs.begin(), local_pairs.end());
+          }
+        });
 
-    parallel_do(
-        b.faces_begin(), b.faces_end(), std::vector<Face_index_pair>{},
-        [&](auto b_fi, auto& local_pairs) {
-          thread_local std::vector<const Leaf*> leaves;
+    return pairs;
+  }
+
+  // Streams the pairs of faces without collecting them.
+  //
+  // The faces of one mesh are queried in parallel, and body(pairs, local_state) is called on the
+  // worker thread as soon as the pairs (left_fi, right_fi) of a query face are found.
+  // The pairs passed to a call share the query face. post(local_state) is called once per worker
+  // thread, as in parallel_do.
+  template <class State, class Body, class Post>
+  Broad_phase_plan operator()(const Triangle_soup& left, const Triangle_soup& right,
+                              const std::vector<Face_tag>& left_face_tags,
+                              const std::vector<Face_tag>& right_face_tags, State state, Body body,
+                              Post post) const {
+    Broad_phase_plan plan;
+
+    Bbox overlap;
+    if (!bbox_intersection(left.bbox(), right.bbox(), overlap)) {
+      // No faces can intersect. All of them are left to classification.
+      return plan;
+    }
+
+    // Only the faces that touch the overlap of their connected component and the components of
+    // the other mesh can intersect. The rest of the components are left to classification.
+    auto left_components = Find_connected_components{}(left);
+    auto right_components = Find_connected_components{}(right);
+    plan.num_left_components = left_components.size();
+    plan.num_right_components = right_components.size();
+
+    std::vector<Bbox> left_overlaps;
+    std::vector<Bbox> right_overlaps;
+    plan.num_component_pairs =
+        component_overlaps(left_components, right_components, left_overlaps, right_overlaps);
+
+    auto left_leaves = active_leaves(left, left_face_tags, left_components, left_overlaps);
+    auto right_leaves = active_leaves(right, right_face_tags, right_components, right_overlaps);
+    if (left_leaves.empty() || right_leaves.empty()) {
+      return plan;
+    }
+
+    auto left_stats = leaf_statistics(left_leaves);
+    auto right_stats = leaf_statistics(right_leaves);
+    auto strategy = Boolean_context::current().broad_phase_strategy();
+    auto automatic = strategy == Broad_phase_strategy::AUTOMATIC;
+    if (automatic) {
+      auto min_cost = std::numeric_limits<double>::infinity();
+      for (auto candidate : {Broad_phase_strategy::AABB_TREE, Broad_phase_strategy::UNIFORM_GRID}) {
+        for (auto index_left : {true, false}) {
+          const auto& a_stats = index_left ? left_stats : right_stats;
+          const auto& b_stats = index_left ? right_stats : left_stats;
+          auto num_pairs = model_num_pairs(a_stats, b_stats, overlap);
+          auto [build_cost, query_cost] = estimate_costs(candidate, a_stats, b_stats, num_pairs);
+          if (build_cost + query_cost < min_cost) {
+            min_cost = build_cost + query_cost;
+            plan.strategy = candidate;
+            plan.index_left = index_left;
+          }
+        }
+      }
+    } else {
+      plan.strategy = strategy;
+      plan.index_left = left.num_faces() < right.num_faces();
+    }
+
+    const auto& a = plan.index_left ? left : right;
+    const auto& a_face_tags = plan.index_left ? left_face_tags : right_face_tags;
+    auto& a_leaves = plan.index_left ? left_leaves : right_leaves;
+    const auto& b_leaves = plan.index_left ? right_leaves : left_leaves;
+    const auto& a_stats = plan.index_left ? left_stats : right_stats;
+    const auto& b_stats = plan.index_left ? right_stats : left_stats;
+    plan.num_index_faces = a_leaves.size();
+    plan.num_query_faces = b_leaves.size();
+    plan.model_num_pairs = model_num_pairs(a_stats, b_stats, overlap);
+
+    Query_context context{a_face_tags, b_leaves, plan.index_left, {}};
+    auto run = [&](const auto& a_index) {
+      plan.sampled_num_pairs = sample_num_pairs(a_index, b_leaves);
+      if (automatic) {
+        auto query_cost =
+            estimate_costs(plan.strategy, a_stats, b_stats, plan.sampled_num_pairs).second;
+        plan.num_threads = choose_num_threads(query_cost, plan.sampled_num_pairs);
+      }
+
+      auto threading_opts = Threading_context::current();
+      threading_opts.set_num_threads(plan.num_threads);
+      Threading_context threading_ctx{threading_opts};
+      query(a_index, context, std::move(state), body, post);
+    };
+
+    switch (plan.strategy) {
+      case Broad_phase_strategy::UNIFORM_GRID: {
+        Uniform_grid<Leaf> a_grid{std::move(a_leaves), overlap};
+        run(a_grid);
+        break;
+      }
 
-          if (b_face_tags.at(b_fi.idx()) != Face_tag::UNKNOWN) {
-            return;
+      default: {
+        if (2 * a_leaves.size() > a.num_faces()) {
+          // Most of the faces are involved. Reuse the tree cached in the mesh, and skip the
+          // faces that are culled.
+          context.a_active.assign(a.num_faces(), false);
+          for (const auto& leaf : a_leaves) {
+            context.a_active.at(leaf.face_index().idx()) = true;
           }
+          run(a.aabb_tree());
+          break;
+        }
+
+        AABB_tree<Leaf> a_tree{std::move(a_leaves)};
+        run(a_tree);
+        break;
+      }
+    }
+
+    return plan;
+  }
+
+ private:
+  struct Query_context {
+    const std::vector<Face_tag>& a_face_tags;
+    const std::vector<Leaf>& b_leaves;
+    bool left_is_a;
+    // If not empty, the faces of the index that are not involved are false.
+    std::vector<bool> a_active;
+  };
+
+  template <class State>
+  struct Query_state {
+    State state;
+    std::vector<const Leaf*> leaves;
+    std::vector<Face_index_pair> pairs;
+  };
+
+  class Component_leaf : public AABB_leaf {
+   public:
+    Component_leaf(const Bbox& bbox, std::size_t index) : AABB_leaf{bbox}, index_{index} {}
+
+    std::size_t index() const { return index_; }
+
+   private:
+    std::size_t index_;
+  };
+
+  struct Leaf_statistics {
+    std::size_t num_leaves{};
+    std::array<double, 3> mean_extent{};
+    double mean_max_extent{};
+    // The coefficient of variation of the largest extents of the leaves.
+    double max_extent_variation{};
+  };
+
+  // The costs are measured in units of box overlap tests.
+  static constexpr double kNodeVisitCost = 2.0;
+  static constexpr double kCellLookupCost = 4.0;
+  static constexpr double kPairCost = 50.0;
+  static constexpr double kMinCostPerThread = 65536.0;
+
+  template <class Index, class State, class Body, class Post>
+  static void query(const Index& a_index, const Query_context& context, State state, Body& body,
+                    Post& post) {
+    const auto& a_face_tags = context.a_face_tags;
+    const auto& b_leaves = context.b_leaves;
+    auto left_is_a = context.left_is_a;
+    const auto& a_active = context.a_active;
+
+    parallel_do(
+        b_leaves.begin(), b_leaves.end(), Query_state<State>{std::move(state), {}, {}},
+        [&](const auto& b_leaf, auto& local_state) {
+          auto& [local_user_state, leaves, pairs] = local_state;
+          auto b_fi = b_leaf.face_index();
 
           leaves.clear();
-          a_tree.get_intersecting_leaves(std::back_inserter(leaves), internal::face_bbox(b, b_fi));
+          a_index.get_intersecting_leaves(std::back_inserter(leaves), b_leaf.bbox());
 
+          pairs.clear();
           for (const auto* leaf : leaves) {
             auto a_fi = leaf->face_index();
-            if (a_face_tags.at(a_fi.idx()) != Face_tag::UNKNOWN) {
+            if (a_face_tags.at(a_fi.idx()) != Face_tag::UNKNOWN ||
+                (!a_active.empty() && !a_active.at(a_fi.idx()))) {
               continue;
             }
 
             if (left_is_a) {
-              local_pairs.emplace_back(a_fi, b_fi);
+              pairs.emplace_back(a_fi, b_fi);
             } else {
-              local_pairs.emplace_back(b_fi, a_fi);
+              pairs.emplace_back(b_fi, a_fi);
             }
           }
-        },
-        [&](auto& local_pairs) {
-          if (pairs.empty()) {
-            pairs = std::move(local_pairs);
-          } else {
-            pairs.insert(pairs.end(), local_pairs.begin(), local_pairs.end());
+
+          if (!pairs.empty()) {
+            body(std::as_const(pairs), local_user_state);
           }
-        });
+        },
+        [&](auto& local_state) { post(local_state.state); });
+  }
 
-    return pairs;
+  // Computes, for each component, the union of its overlaps with the components of the other
+  // mesh. Returns the number of overlapping pairs of components.
+  static std::size_t component_overlaps(const Connected_components& left,
+                                        const Connected_components& right,
+                                        std::vector<Bbox>& left_overlaps,
+                                        std::vector<Bbox>& right_overlaps) {
+    left_overlaps.assign(left.size(), Bbox{});
+    right_overlaps.assign(right.size(), Bbox{});
+
+    std::vector<Component_leaf> left_leaves;
+    left_leaves.reserve(left.size());
+    for (std::size_t i = 0; i < left.size(); ++i) {
+      left_leaves.emplace_back(left.bboxes.at(i), i);
+    }
+    AABB_tree<Component_leaf> left_tree{std::move(left_leaves)};
+
+    std::size_t num_pairs{};
+    std::vector<const Component_leaf*> leaves;
+    for (std::size_t j = 0; j < right.size(); ++j) {
+      leaves.clear();
+      left_tree.get_intersecting_leaves(std::back_inserter(leaves), right.bboxes.at(j));
+      for (const auto* leaf : leaves) {
+        auto i = leaf->index();
+        Bbox overlap;
+        if (bbox_intersection(left.bboxes.at(i), right.bboxes.at(j), overlap)) {
+          left_overlaps.at(i) += overlap;
+          right_overlaps.at(j) += overlap;
+          ++num_pairs;
+        }
+      }
+    }
+
+    return num_pairs;
+  }
+
+  static std::vector<Leaf> active_leaves(const Triangle_soup& m,
+                                         const std::vector<Face_tag>& face_tags,
+                                         const Connected_components& components,
+                                         const std::vector<Bbox>& overlaps) {
+    std::vector<Leaf> leaves;
+    for (auto fi : m.faces()) {
+      if (face_tags.at(fi.idx()) != Face_tag::UNKNOWN) {
+        continue;
+      }
+
+      auto bbox = internal::face_bbox(m, fi);
+      if (CGAL::do_overlap(bbox, overlaps.at(components.face_components.at(fi.idx())))) {
+        leaves.emplace_back(bbox, fi);
+      }
+    }
+    return leaves;
+  }
+
+  static Leaf_statistics leaf_statistics(const std::vector<Leaf>& leaves) {
+    Leaf_statistics stats{leaves.size()};
+
+    double sum_squared_max_extent{};
+    for (const auto& leaf : leaves) {
+      const auto& bbox = leaf.bbox();
+      double max_extent{};
+      for (int i = 0; i < 3; ++i) {
+        auto extent = bbox.max(i) - bbox.min(i);
+        stats.mean_extent.at(i) += extent;
+        max_extent = std::max(max_extent, extent);
+      }
+      stats.mean_max_extent += max_extent;
+      sum_squared_max_extent += max_extent * max_extent;
+    }
+
+    auto n = static_cast<double>(leaves.size());
+    for (auto& extent : stats.mean_extent) {
+      extent /= n;
+    }
+    stats.mean_max_extent /= n;
+    auto mean = stats.mean_max_extent;
+    auto variance = std::max(0.0, sum_squared_max_extent / n - mean * mean);
+    stats.max_extent_variation = mean > 0.0 ? std::sqrt(variance) / mean : 0.0;
+    return stats;
+  }
+
+  // Estimates the number of overlapping pairs of boxes, assuming that they are scattered
+  // uniformly over the overlap of the two meshes.
+  static double model_num_pairs(const Leaf_statistics& a, const Leaf_statistics& b,
+                                const Bbox& overlap) {
+    auto num_pairs = static_cast<double>(a.num_leaves) * static_cast<double>(b.num_leaves);
+    for (int i = 0; i < 3; ++i) {
+      auto extent = overlap.max(i) - overlap.min(i);
+      if (extent > 0.0) {
+        num_pairs *= std::min(1.0, (a.mean_extent.at(i) + b.mean_extent.at(i)) / extent);
+      }
+    }
+    return num_pairs;
+  }
+
+  // Estimates the costs of building an index over a and querying it with the faces of b.
+  static std::pair<double, double> estimate_costs(Broad_phase_strategy strategy,
+                                                  const Leaf_statistics& a,
+                                                  const Leaf_statistics& b, double num_pairs) {
+    auto n_a = static_cast<double>(a.num_leaves);
+    auto n_b = static_cast<double>(b.num_leaves);
+
+    if (strategy == Broad_phase_strategy::UNIFORM_GRID) {
+      // Uniform_grid chooses the cell size to be the mean of the largest extents.
+      auto cell_size = a.mean_max_extent;
+      if (!(cell_size > 0.0)) {
+        return {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+      }
+
+      double cells_per_leaf = 1.0;
+      double cells_per_query = 1.0;
+      for (std::size_t i = 0; i < 3; ++i) {
+        cells_per_leaf *= 1.0 + a.mean_extent.at(i) / cell_size;
+        cells_per_query *= 1.0 + b.mean_extent.at(i) / cell_size;
+      }
+      // Large faces crowd the cells they share with small ones.
+      auto leaves_per_cell =
+          cells_per_leaf * (1.0 + a.max_extent_variation * a.max_extent_variation);
+      auto num_entries = n_a * cells_per_leaf;
+      auto build_cost = num_entries * std::log2(num_entries + 1.0);
+      auto query_cost = n_b * cells_per_query * (kCellLookupCost + leaves_per_cell) + num_pairs;
+      return {build_cost, query_cost};
+    }
+
+    auto depth = std::log2(n_a + 1.0);
+    auto build_cost = n_a * depth;
+    auto query_cost = n_b * kNodeVisitCost * depth + num_pairs;
+    return {build_cost, query_cost};
+  }
+
+  template <class Index>
+  static double sample_num_pairs(const Index& a_index, const std::vector<Leaf>& b_leaves) {
+    static constexpr std::size_t kMaxSamples = 256;
+
+    auto stride = std::max(std::size_t{1}, b_leaves.size() / kMaxSamples);
+    std::vector<const Leaf*> leaves;
+    std::size_t num_samples{};
+    for (std::size_t i = 0; i < b_leaves.size(); i += stride) {
+      a_index.get_intersecting_leaves(std::back_inserter(leaves), b_leaves.at(i).bbox());
+      ++num_samples;
+    }
+
+    return static_cast<double>(leaves.size()) * static_cast<double>(b_leaves.size()) /
+           static_cast<double>(num_samples);
+  }
+
+  // Uses only as many threads as the work can keep busy.
+  static std::size_t choose_num_threads(double query_cost, double num_pairs) {
+    auto cost = query_cost + kPairCost * num_pairs;
+    auto max_num_threads = Threading_context::current().num_threads();
+    auto num_threads = std::ceil(cost / kMinCostPerThread);
+    return static_cast<std::size_t>(
+        std::clamp(num_threads, 1.0, static_cast<double>(max_num_threads)));
+  }
+
+  static bool bbox_intersection(const Bbox& a, const Bbox& b, Bbox& result) {
+    if (!CGAL::do_overlap(a, b)) {
+      return false;
+    }
+
+    result = Bbox{std::max(a.xmin(), b.xmin()), std::max(a.ymin(), b.ymin()),
+                  std::max(a.zmin(), b.zmin()), std::min(a.xmax(), b.xmax()),
+                  std::min(a.ymax(), b.ymax()), std::min(a.zmax(), b.zmax())};
+    return true;
   }
 };
 
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Kernel/global_functions.h>
+#include <CGAL/number_utils.h>
+#include <kigumi/Face_tag.h>
+#include <kigumi/Mesh_entities.h>
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Mix.h>
+#include <kigumi/Mixed.h>
+#include <kigumi/Point_list.h>
+#include <kigumi/Round_vertices.h>
+#include <kigumi/Triangle_soup.h>
+#include <kigumi/Warnings.h>
+
+#include <algorithm>
+#include <boost/container_hash/hash.hpp>
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <boost/unordered/unordered_flat_set.hpp>
+#include <exception>
+#include <initializer_list>
+#include <iostream>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace kigumi {
+
+// Runs Mix with double coordinates, where the intersection points are rounded to doubles but
+// the predicates on the rounded points are still exact, and checks that the result is
+// consistent. Returns std::nullopt if some input points are not exactly representable by doubles,
+// e.g., the intersection points in the result of a previous operation, or if the run fails or the
+// result is inconsistent. In that case, the caller falls back to the exact kernel. Otherwise, the
+// returned warnings include Warnings::INEXACT_INTERSECTION_POINTS.
+template <class K, class FaceData>
+class Inexact_mix {
+  using Inexact_kernel = CGAL::Exact_predicates_inexact_constructions_kernel;
+  using Inexact_mixed_triangle_soup = Mixed_triangle_soup<Inexact_kernel, FaceData>;
+  using Mixed_triangle_soup = Mixed_triangle_soup<K, FaceData>;
+  using Triangle_soup = Triangle_soup<K, FaceData>;
+
+ public:
+  std::optional<std::pair<Mixed_triangle_soup, Warnings>> operator()(
+      const Triangle_soup& left, const Triangle_soup& right) const {
+    std::cout << "Mixing with inexact constructions..." << std::endl;
+
+    // Rounding the input points would change the result.
+    if (!has_double_points(left) || !has_double_points(right)) {
+      std::cout << "  inexact path skipped: some input points are not doubles" << std::endl;
+      return std::nullopt;
+    }
+
+    std::pair<Inexact_mixed_triangle_soup, Warnings> result;
+    try {
+      result = Mix<Inexact_kernel, FaceData>{}(convert<Inexact_kernel>(left),
+                                               convert<Inexact_kernel>(right));
+    } catch (const std::exception& e) {
+      std::cout << "  inexact path failed: " << e.what() << std::endl;
+      return std::nullopt;
+    }
+
+    const auto& m = result.first;
+    if (!is_classified(m)) {
+      std::cout << "  inexact path failed: some faces are not classified" << std::endl;
+      return std::nullopt;
+    }
+    if (has_degenerate_faces(m)) {
+      std::cout << "  inexact path failed: degenerate faces" << std::endl;
+      return std::nullopt;
+    }
+    if (has_intersecting_faces(m, left, right)) {
+      std::cout << "  inexact path failed: intersecting faces" << std::endl;
+      return std::nullopt;
+    }
+    if (!is_closed(m, true) || !is_closed(m, false)) {
+      std::cout << "  inexact path failed: the corefined meshes are not closed" << std::endl;
+      return std::nullopt;
+    }
+
+    std::cout << "  inexact path succeeded" << std::endl;
+    return std::pair{convert<K>(m), result.second | Warnings::INEXACT_INTERSECTION_POINTS};
+  }
+
+ private:
+  template <class Kernel, class SourceKernel, class Data>
+  static kigumi::Triangle_soup<Kernel, Data> convert(
+      const kigumi::Triangle_soup<SourceKernel, Data>& m) {
+    using Point = typename Kernel::Point_3;
+
+    std::vector<Point> points;
+    points.reserve(m.num_vertices());
+    for (auto vi : m.vertices()) {
+      const auto& p = m.point(vi);
+      points.emplace_back(CGAL::to_double(p.x()), CGAL::to_double(p.y()),
+                          CGAL::to_double(p.z()));
+    }
+
+    std::vector<Face> faces;
+    std::vector<Data> face_data;
+    faces.reserve(m.num_faces());
+    face_data.reserve(m.num_faces());
+    for (auto fi : m.faces()) {
+      faces.push_back(m.face(fi));
+      face_data.push_back(m.data(fi));
+    }
+
+    return {std::move(points), std::move(faces), std::move(face_data)};
+  }
+
+  static bool has_double_points(const Triangle_soup& m) {
+    internal::Double_point p;
+    for (auto vi : m.vertices()) {
+      if (!internal::to_double_point(m.point(vi), p)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static bool is_classified(const Inexact_mixed_triangle_soup& m) {
+    for (auto fi : m.faces()) {
+      if (m.data(fi).tag == Face_tag::UNKNOWN) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Rounding can collapse the faces around intersection points.
+  static bool has_degenerate_faces(const Inexact_mixed_triangle_soup& m) {
+    for (auto fi : m.faces()) {
+      const auto& f = m.face(fi);
+      if (CGAL::collinear(m.point(f[0]), m.point(f[1]), m.point(f[2]))) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Rounding can also make the faces around intersection points cross other faces, which is not
+  // visible to the other checks. The faces that coincide between the meshes are the only
+  // intersections allowed other than at their shared vertices and edges.
+  static bool has_intersecting_faces(const Inexact_mixed_triangle_soup& m,
+                                     const Triangle_soup& left, const Triangle_soup& right) {
+    using Double_point = internal::Double_point;
+    using Inexact_point = Inexact_kernel::Point_3;
+
+    boost::unordered_flat_set<Double_point, boost::hash<Double_point>> input_points;
+    Double_point p;
+    for (const auto* soup : {&left, &right}) {
+      for (auto vi : soup->vertices()) {
+        internal::to_double_point(soup->point(vi), p);
+        input_points.insert(p);
+      }
+    }
+
+    std::vector<bool> rounded(m.num_vertices(), false);
+    for (auto vi : m.vertices()) {
+      internal::to_double_point(m.point(vi), p);
+      rounded.at(vi.idx()) = !input_points.contains(p);
+    }
+
+    std::vector<Face_index> fis;
+    for (auto fi : m.faces()) {
+      const auto& f = m.face(fi);
+      if (rounded.at(f[0].idx()) || rounded.at(f[1].idx()) || rounded.at(f[2].idx())) {
+        fis.push_back(fi);
+      }
+    }
+
+    if (fis.empty()) {
+      return false;
+    }
+
+    auto sorted_face = [&](Face_index fi) {
+      auto f = m.face(fi);
+      std::sort(f.begin(), f.end());
+      return f;
+    };
+
+    auto pairs = internal::defective_face_pairs(
+        m, fis, [&](Vertex_index vi) -> const Inexact_point& { return m.point(vi); });
+    return std::any_of(pairs.begin(), pairs.end(), [&](const auto& pair) {
+      auto [fi, fj] = pair;
+      return fi == fj || m.data(fi).from_left == m.data(fj).from_left ||
+             sorted_face(fi) != sorted_face(fj);
+    });
+  }
+
+  // Returns true if every edge of the faces from the mesh is shared by as many faces in one
+  // direction as in the other, which holds if the triangulations along the intersection are
+  // consistent. Open inputs always fail this check, and are handled by the exact path.
+  static bool is_closed(const Inexact_mixed_triangle_soup& m, bool from_left) {
+    boost::unordered_flat_map<Edge, int, Edge_hash> edge_balances;
+    for (auto fi : m.faces()) {
+      if (m.data(fi).from_left != from_left) {
+        continue;
+      }
+      const auto& f = m.face(fi);
+      for (std::size_t i = 0; i < 3; ++i) {
+        auto u = f.at(i);
+        auto v = f.at((i + 1) % 3);
+        edge_balances[make_edge(u, v)] += u < v ? 1 : -1;
+      }
+    }
+
+    for (const auto& [edge, balance] : edge_balances) {
+      if (balance != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+};
+
+}  // namespace kigumi
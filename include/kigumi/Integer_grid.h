@@ -0,0 +1,118 @@
+#pragma once
+
+#include <CGAL/number_utils.h>
+#include <kigumi/Mesh_entities.h>
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Round_vertices.h>
+#include <kigumi/Triangle_soup.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace kigumi {
+
+// The bound on the absolute values of the coordinates of the vertices snapped to an integer grid,
+// within which the integers are exactly representable by doubles.
+constexpr double kMaxIntegerGridCoordinate = 0x1p53;
+
+namespace internal {
+
+template <class K, class FaceData, class F>
+Triangle_soup<K, FaceData> transform_points(const Triangle_soup<K, FaceData>& m, F f) {
+  std::vector<typename K::Point_3> points;
+  points.reserve(m.num_vertices());
+  for (auto vi : m.vertices()) {
+    points.push_back(f(m.point(vi)));
+  }
+
+  std::vector<Face> faces;
+  std::vector<FaceData> face_data;
+  faces.reserve(m.num_faces());
+  face_data.reserve(m.num_faces());
+  for (auto fi : m.faces()) {
+    faces.push_back(m.face(fi));
+    face_data.push_back(m.data(fi));
+  }
+
+  return {std::move(points), std::move(faces), std::move(face_data)};
+}
+
+}  // namespace internal
+
+// Returns a copy of the soup with the vertices snapped to the grid with the given spacing,
+// scaled by 1 / spacing so that the grid points have integer coordinates.
+// The coordinates of the result are exactly representable by doubles, for which most of the
+// predicates are decided without evaluating the lazy-exact values.
+// Throws std::invalid_argument if a snapped coordinate exceeds kMaxIntegerGridCoordinate, or if
+// snapping makes faces degenerate or intersecting that were not before. The defects that are
+// present before snapping are left as they are.
+template <class K, class FaceData>
+Triangle_soup<K, FaceData> snap_to_integer_grid(const Triangle_soup<K, FaceData>& m,
+                                                double spacing) {
+  using Point = typename K::Point_3;
+
+  if (!(spacing > 0.0)) {
+    throw std::invalid_argument("grid spacing must be positive");
+  }
+
+  auto snap = [&](const auto& x) {
+    auto k = std::round(CGAL::to_double(x) / spacing);
+    if (!(std::abs(k) <= kMaxIntegerGridCoordinate)) {
+      throw std::invalid_argument("the mesh does not fit in the integer grid");
+    }
+    return k;
+  };
+
+  auto snapped = internal::transform_points(
+      m, [&](const Point& p) { return Point{snap(p.x()), snap(p.y()), snap(p.z())}; });
+
+  // Only the faces around the vertices that are not on the grid can change.
+  std::vector<bool> moved(m.num_vertices(), false);
+  for (auto vi : m.vertices()) {
+    const auto& p = m.point(vi);
+    const auto& q = snapped.point(vi);
+    moved.at(vi.idx()) = q.x() * spacing != p.x() || q.y() * spacing != p.y() ||
+                         q.z() * spacing != p.z();
+  }
+
+  std::vector<Face_index> fis;
+  for (auto fi : m.faces()) {
+    const auto& f = m.face(fi);
+    if (moved.at(f[0].idx()) || moved.at(f[1].idx()) || moved.at(f[2].idx())) {
+      fis.push_back(fi);
+    }
+  }
+
+  if (fis.empty()) {
+    return snapped;
+  }
+
+  // Both soups have the same faces, and the defects are invariant under the scaling.
+  auto original_defects = internal::defective_face_pairs(
+      m, fis, [&](Vertex_index vi) -> const Point& { return m.point(vi); });
+  auto snapped_defects = internal::defective_face_pairs(
+      snapped, fis, [&](Vertex_index vi) -> const Point& { return snapped.point(vi); });
+  if (!std::includes(original_defects.begin(), original_defects.end(), snapped_defects.begin(),
+                     snapped_defects.end())) {
+    throw std::invalid_argument("snapping makes faces degenerate or intersecting");
+  }
+
+  return snapped;
+}
+
+// Returns a copy of the soup scaled by spacing, which undoes the scaling of snap_to_integer_grid.
+// The coordinates of the result are the exact products, which are not representable by doubles
+// in general unless spacing is a power of two. Use round_vertices to round them.
+template <class K, class FaceData>
+Triangle_soup<K, FaceData> scale_from_integer_grid(const Triangle_soup<K, FaceData>& m,
+                                                   double spacing) {
+  using Point = typename K::Point_3;
+
+  return internal::transform_points(
+      m, [&](const Point& p) { return Point{p.x() * spacing, p.y() * spacing, p.z() * spacing}; });
+}
+
+}  // namespace kigumi
@@ -8,6 +8,7 @@
 #include <boost/container_hash/hash.hpp>
 #include <boost/unordered/unordered_flat_map.hpp>
 #include <limits>
+#include <optional>
 #include <tuple>
 #include <utility>
 
@@ -15,16 +16,42 @@ namespace kigumi {
 
 template <class K>
 class Intersection_point_inserter {
-  using Line_line_intersection_key = std::array<std::size_t, 4>;
-  using Plane_line_intersection_key = std::array<std::size_t, 5>;
   using Point = typename K::Point_3;
   using Point_list = Point_list<K>;
 
  public:
+  // Identifies an intersection point that needs to be constructed by the ids of the vertices:
+  // {a, b, c, p, q} for the intersection of the plane abc and the line pq, or
+  // {a, b, p, q, kNone} for the intersection of the lines ab and pq.
+  // The ids are ordered so that the same point is always identified by the same key.
+  using Key = std::array<std::size_t, 5>;
+
+  static constexpr std::size_t kNone = std::numeric_limits<std::size_t>::max();
+
   explicit Intersection_point_inserter(Point_list& points) : points_(points) {}
 
   std::size_t insert(Triangle_region left_region, std::size_t a, std::size_t b, std::size_t c,
                      Triangle_region right_region, std::size_t p, std::size_t q, std::size_t r) {
+    Key key;
+    if (auto id = vertex_or_key(left_region, a, b, c, right_region, p, q, r, key)) {
+      return *id;
+    }
+
+    auto [it, inserted] = cache_.emplace(key, kNone);
+
+    if (inserted) {
+      it->second = points_.insert(construct(key));
+    }
+
+    return it->second;
+  }
+
+  // Returns the id of the intersection point if it is one of the vertices.
+  // Otherwise, stores the key of the point into key and returns std::nullopt.
+  static std::optional<std::size_t> vertex_or_key(Triangle_region left_region, std::size_t a,
+                                                  std::size_t b, std::size_t c,
+                                                  Triangle_region right_region, std::size_t p,
+                                                  std::size_t q, std::size_t r, Key& key) {
     if (left_region == Triangle_region::LEFT_VERTEX_0) {
       return a;
     }
@@ -56,17 +83,37 @@ class Intersection_point_inserter {
     }
 
     if (left_region == Triangle_region::LEFT_FACE) {
-      return insert_plane_line_intersection(a, b, c, p, q);
-    }
-    if (right_region == Triangle_region::RIGHT_FACE) {
-      return insert_plane_line_intersection(p, q, r, a, b);
+      key = plane_line_intersection_key(a, b, c, p, q);
+    } else if (right_region == Triangle_region::RIGHT_FACE) {
+      key = plane_line_intersection_key(p, q, r, a, b);
+    } else {
+      key = line_line_intersection_key(a, b, p, q);
     }
-    return insert_line_line_intersection(a, b, p, q);
+    return std::nullopt;
+  }
+
+  // Constructs the point identified by the key. This does not modify the point list,
+  // and can be called concurrently.
+  Point construct(const Key& key) const {
+    if (key[4] == kNone) {
+      const auto& pa = points_.at(key[0]);
+      const auto& pb = points_.at(key[1]);
+      const auto& pp = points_.at(key[2]);
+      const auto& pq = points_.at(key[3]);
+      return typename K::Construct_line_line_intersection_point_3{}(pa, pb, pp, pq);
+    }
+
+    const auto& pa = points_.at(key[0]);
+    const auto& pb = points_.at(key[1]);
+    const auto& pc = points_.at(key[2]);
+    const auto& pp = points_.at(key[3]);
+    const auto& pq = points_.at(key[4]);
+    return typename K::Construct_plane_line_intersection_point_3{}(pa, pb, pc, pp, pq);
   }
 
  private:
-  std::size_t insert_line_line_intersection(std::size_t a, std::size_t b, std::size_t p,
-                                            std::size_t q) {
+  static Key line_line_intersection_key(std::size_t a, std::size_t b, std::size_t p,
+                                        std::size_t q) {
     if (a > b) {
       std::swap(a, b);
     }
@@ -78,26 +125,11 @@ class Intersection_point_inserter {
       std::swap(b, q);
     }
 
-    Line_line_intersection_key key{a, b, p, q};
-    auto [it, inserted] =
-        line_line_intersection_cache_.emplace(key, std::numeric_limits<std::size_t>::max());
-
-    if (inserted) {
-      const auto& pa = points_.at(a);
-      const auto& pb = points_.at(b);
-      const auto& pp = points_.at(p);
-      const auto& pq = points_.at(q);
-
-      auto point = typename K::Construct_line_line_intersection_point_3{}(pa, pb, pp, pq);
-      auto id = points_.insert(std::move(point));
-      it->second = id;
-    }
-
-    return it->second;
+    return {a, b, p, q, kNone};
   }
 
-  std::size_t insert_plane_line_intersection(std::size_t a, std::size_t b, std::size_t c,
-                                             std::size_t p, std::size_t q) {
+  static Key plane_line_intersection_key(std::size_t a, std::size_t b, std::size_t c,
+                                         std::size_t p, std::size_t q) {
     if (a > b) {
       std::swap(a, b);
     }
@@ -111,32 +143,11 @@ class Intersection_point_inserter {
       std::swap(p, q);
     }
 
-    Plane_line_intersection_key key{a, b, c, p, q};
-    auto [it, inserted] =
-        plane_line_intersection_cache_.emplace(key, std::numeric_limits<std::size_t>::max());
-
-    if (inserted) {
-      const auto& pa = points_.at(a);
-      const auto& pb = points_.at(b);
-      const auto& pc = points_.at(c);
-      const auto& pp = points_.at(p);
-      const auto& pq = points_.at(q);
-
-      auto point = typename K::Construct_plane_line_intersection_point_3{}(pa, pb, pc, pp, pq);
-      auto id = points_.insert(std::move(point));
-      it->second = id;
-    }
-
-    return it->second;
+    return {a, b, c, p, q};
   }
 
   Point_list& points_;
-  boost::unordered_flat_map<Line_line_intersection_key, std::size_t,
-                            boost::hash<Line_line_intersection_key>>
-      line_line_intersection_cache_;
-  boost::unordered_flat_map<Plane_line_intersection_key, std::size_t,
-                            boost::hash<Plane_line_intersection_key>>
-      plane_line_intersection_cache_;
+  boost::unordered_flat_map<Key, std::size_t, boost::hash<Key>> cache_;
 };
 
 }  // namespace kigumi
@@ -1,33 +1,94 @@
 #pragma once
 
+#include <CGAL/Kernel/global_functions.h>
+#include <CGAL/enum.h>
+#include <CGAL/number_utils.h>
+#include <CGAL/version.h>
+#include <kigumi/parallel_do.h>
+#include <kigumi/parallel_sort.h>
+
+#include <algorithm>
+#include <array>
 #include <boost/container_hash/hash.hpp>
+#include <boost/iterator/counting_iterator.hpp>
 #include <boost/unordered/unordered_flat_map.hpp>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace kigumi {
 
+namespace internal {
+
+using Double_point = std::array<double, 3>;
+
+// Stores the coordinates of the point into p if they are exactly representable by doubles.
+template <class Point>
+bool to_double_point(const Point& point, Double_point& p) {
+  if constexpr (requires { point.approx(); }) {
+    const auto& approx = point.approx();
+    if (!approx.x().is_point() || !approx.y().is_point() || !approx.z().is_point()) {
+      return false;
+    }
+    p = {approx.x().inf(), approx.y().inf(), approx.z().inf()};
+  } else if constexpr (std::is_same_v<std::remove_cvref_t<decltype(point.x())>, double>) {
+    p = {point.x(), point.y(), point.z()};
+  } else {
+    // The coordinates of other number types must be converted back without loss.
+    using FT = std::remove_cvref_t<decltype(point.x())>;
+    p = {CGAL::to_double(point.x()), CGAL::to_double(point.y()), CGAL::to_double(point.z())};
+    if (FT{p[0]} != point.x() || FT{p[1]} != point.y() || FT{p[2]} != point.z()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace internal
+
 template <class K>
 struct Point_3_hash {
   std::size_t operator()(const typename K::Point_3& p) const noexcept {
-    if (!p.approx().x().is_point() || !p.approx().y().is_point() || !p.approx().z().is_point()) {
-      p.exact();
-    }
     std::size_t seed{};
-    boost::hash_combine(seed, p.approx().x().inf());
-    boost::hash_combine(seed, p.approx().y().inf());
-    boost::hash_combine(seed, p.approx().z().inf());
+    if constexpr (requires { p.approx(); }) {
+      if (!p.approx().x().is_point() || !p.approx().y().is_point() ||
+          !p.approx().z().is_point()) {
+        p.exact();
+      }
+      boost::hash_combine(seed, p.approx().x().inf());
+      boost::hash_combine(seed, p.approx().y().inf());
+      boost::hash_combine(seed, p.approx().z().inf());
+    } else {
+      boost::hash_combine(seed, CGAL::to_double(p.x()));
+      boost::hash_combine(seed, CGAL::to_double(p.y()));
+      boost::hash_combine(seed, CGAL::to_double(p.z()));
+    }
     return seed;
   }
 };
 
+// A list of points. Along with the lazy-exact points, the coordinates of the points that are
+// exactly representable by doubles, which are most of the input vertices, are stored
+// contiguously, so that filtered predicates can read them without touching the lazy handles.
+// This is a fast path for the predicates, not a compact representation: every point keeps its
+// lazy-exact handle, and the coordinates add 24 bytes per point.
 template <class K>
 class Point_list {
+  using Double_point = internal::Double_point;
   using Point = typename K::Point_3;
 
  public:
   const Point& at(std::size_t i) const { return points_.at(i); }
 
+  // Returns the coordinates of the i-th point if they are exactly representable by doubles,
+  // or NaNs otherwise.
+  const Double_point& double_point(std::size_t i) const { return double_points_.at(i); }
+
+  bool is_double_point(std::size_t i) const { return !std::isnan(double_points_.at(i)[0]); }
+
   auto begin() const { return points_.begin(); }
 
   auto end() const { return points_.end(); }
@@ -36,23 +97,84 @@ class Point_list {
 
   std::size_t insert(Point&& p) {
     if (!check_uniqueness_) {
-      points_.push_back(std::move(p));
+      push_back(std::move(p));
       return points_.size() - 1;
     }
 
     auto [it, inserted] = point_to_index_.emplace(p, points_.size());
 
     if (inserted) {
-      points_.push_back(std::move(p));
+      push_back(std::move(p));
     }
 
     return it->second;
   }
 
-  std::vector<Point> take_points() { return std::move(points_); }
+  // Inserts the points in bulk, merging the ones that are equal to each other, and returns
+  // their ids. The ids are the same as inserting the points one by one with the uniqueness check,
+  // but the points are welded in parallel by sorting. The points already in the list are not
+  // taken into account.
+  std::vector<std::size_t> insert_unique(const std::vector<const Point*>& points) {
+    auto n = points.size();
+
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    auto less = [&](std::size_t i, std::size_t j) {
+      auto c = CGAL::compare_xyz(*points.at(i), *points.at(j));
+      return c == CGAL::SMALLER || (c == CGAL::EQUAL && i < j);
+    };
+
+    // Each run of equal points is led by the first occurrence.
+    std::vector<char> leads_run(n);
+    auto mark_lead = [&](std::size_t k) {
+      leads_run.at(k) =
+          static_cast<char>(k == 0 || *points.at(order.at(k - 1)) != *points.at(order.at(k)));
+    };
+
+#if CGAL_VERSION_NR >= CGAL_VERSION_NUMBER(5, 5, 0)
+    parallel_sort(order.begin(), order.end(), less);
+    parallel_do(boost::counting_iterator<std::size_t>(0), boost::counting_iterator<std::size_t>(n),
+                mark_lead);
+#else
+    // The comparisons can evaluate lazy-exact points, which is not thread-safe before CGAL 5.5.
+    std::sort(order.begin(), order.end(), less);
+    for (std::size_t k = 0; k < n; ++k) {
+      mark_lead(k);
+    }
+#endif
+
+    std::vector<std::size_t> first_occurrences(n);
+    std::size_t first{};
+    for (std::size_t k = 0; k < n; ++k) {
+      if (leads_run.at(k) != 0) {
+        first = order.at(k);
+      }
+      first_occurrences.at(order.at(k)) = first;
+    }
+
+    std::vector<std::size_t> ids(n);
+    reserve(points_.size() + n);
+    for (std::size_t i = 0; i < n; ++i) {
+      auto j = first_occurrences.at(i);
+      if (j == i) {
+        ids.at(i) = points_.size();
+        push_back(Point{*points.at(i)});
+      } else {
+        ids.at(i) = ids.at(j);
+      }
+    }
+
+    return ids;
+  }
+
+  std::vector<Point> take_points() {
+    double_points_ = {};
+    return std::move(points_);
+  }
 
   void reserve(std::size_t capacity) {
     points_.reserve(capacity);
+    double_points_.reserve(capacity);
     if (!check_uniqueness_) {
       return;
     }
@@ -70,7 +192,18 @@ class Point_list {
   }
 
  private:
+  void push_back(Point&& p) {
+    constexpr auto kNaN = std::numeric_limits<double>::quiet_NaN();
+
+    auto& dp = double_points_.emplace_back();
+    if (!internal::to_double_point(p, dp)) {
+      dp = {kNaN, kNaN, kNaN};
+    }
+    points_.push_back(std::move(p));
+  }
+
   std::vector<Point> points_;
+  std::vector<Double_point> double_points_;
   boost::unordered_flat_map<Point, std::size_t, Point_3_hash<K>> point_to_index_;
   bool check_uniqueness_{};
 };
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <CGAL/Kernel/global_functions.h>
+#include <CGAL/number_utils.h>
+#include <kigumi/Face_face_filter.h>
+#include <kigumi/Face_face_intersection.h>
+#include <kigumi/Mesh_entities.h>
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Point_list.h>
+#include <kigumi/Triangle_soup.h>
+#include <kigumi/mesh_utility.h>
+
+#include <algorithm>
+#include <array>
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace kigumi {
+
+namespace internal {
+
+// Returns the pairs of faces that are defective when the vertices are moved to point_of(vi):
+// {fi, fi} if fi is degenerate, and {fi, fj} with fi < fj if fi and fj intersect other than at
+// their shared vertices or their shared edge. Only the pairs with a face in fis are tested.
+// The bounding boxes of the faces of m must enclose the moved faces.
+template <class K, class FaceData, class PointOf>
+std::vector<std::pair<Face_index, Face_index>> defective_face_pairs(
+    const Triangle_soup<K, FaceData>& m, const std::vector<Face_index>& fis,
+    const PointOf& point_of) {
+  using Face_pair = std::pair<Face_index, Face_index>;
+  using Leaf = typename Triangle_soup<K, FaceData>::Leaf;
+
+  auto is_trivially_degenerate = [&](Face_index fi) {
+    const auto& f = m.face(fi);
+    return f[0] == f[1] || f[1] == f[2] || f[2] == f[0];
+  };
+
+  const auto& tree = m.aabb_tree();
+  std::vector<const Leaf*> leaves;
+  std::vector<Face_pair> pairs;
+  for (auto fi : fis) {
+    if (is_trivially_degenerate(fi)) {
+      continue;
+    }
+    pairs.emplace_back(fi, fi);
+    leaves.clear();
+    tree.get_intersecting_leaves(std::back_inserter(leaves), face_bbox(m, fi));
+    for (const auto* leaf : leaves) {
+      auto fj = leaf->face_index();
+      if (fj != fi && !is_trivially_degenerate(fj)) {
+        pairs.emplace_back(std::min(fi, fj), std::max(fi, fj));
+      }
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  // Only the points of the faces in the pairs are inserted.
+  Point_list<K> points;
+  boost::unordered_flat_map<Vertex_index, std::size_t, std::hash<Vertex_index>> ids;
+  auto face_ids = [&](Face_index fi) {
+    std::array<std::size_t, 3> f{};
+    for (std::size_t i = 0; i < 3; ++i) {
+      auto vi = m.face(fi).at(i);
+      auto [it, inserted] = ids.emplace(vi, points.size());
+      if (inserted) {
+        points.insert(point_of(vi));
+      }
+      f.at(i) = it->second;
+    }
+    std::sort(f.begin(), f.end());
+    return f;
+  };
+  for (auto [fi, fj] : pairs) {
+    face_ids(fi);
+    face_ids(fj);
+  }
+
+  boost::unordered_flat_map<Face_index, bool, std::hash<Face_index>> degenerate;
+  auto is_degenerate = [&](Face_index fi) {
+    auto [it, inserted] = degenerate.emplace(fi, false);
+    if (inserted) {
+      const auto& f = m.face(fi);
+      it->second = CGAL::collinear(point_of(f[0]), point_of(f[1]), point_of(f[2]));
+    }
+    return it->second;
+  };
+
+  Face_face_filter<K> face_face_filter{points};
+  Face_face_intersection<K> face_face_intersection{points};
+  std::vector<Face_pair> defective_pairs;
+  for (auto [fi, fj] : pairs) {
+    if (fi == fj) {
+      if (is_degenerate(fi)) {
+        defective_pairs.emplace_back(fi, fj);
+      }
+      continue;
+    }
+    if (is_degenerate(fi) || is_degenerate(fj)) {
+      continue;
+    }
+
+    auto f = face_ids(fi);
+    auto g = face_ids(fj);
+    if (face_face_filter(f[0], f[1], f[2], g[0], g[1], g[2])) {
+      continue;
+    }
+
+    std::size_t num_shared_vertices{};
+    for (auto id : f) {
+      num_shared_vertices += std::count(g.begin(), g.end(), id);
+    }
+    if (num_shared_vertices > 0 && face_face_intersection.touches_only_at_shared_vertices(
+                                       f[0], f[1], f[2], g[0], g[1], g[2])) {
+      continue;
+    }
+
+    // Same as Find_defects::overlapping_faces.
+    auto inter = face_face_intersection(f[0], f[1], f[2], g[0], g[1], g[2]);
+    if (!inter.empty() && (inter.size() > 2 || num_shared_vertices < inter.size())) {
+      defective_pairs.emplace_back(fi, fj);
+    }
+  }
+
+  return defective_pairs;
+}
+
+}  // namespace internal
+
+// Rounds the coordinates of the vertices to doubles, so that their size stays bounded when
+// the results are used in further operations. The vertices of the faces that become degenerate
+// or start to intersect other faces by rounding keep their exact coordinates, and the defects
+// that are present before rounding are left as they are.
+// Returns the number of vertices that are rounded.
+template <class K, class FaceData>
+std::size_t round_vertices(Triangle_soup<K, FaceData>& m) {
+  using Point = typename K::Point_3;
+
+  std::vector<Point> rounded_points;
+  std::vector<bool> rounded(m.num_vertices(), false);
+  std::vector<Vertex_index> changed_vertices;
+  rounded_points.reserve(m.num_vertices());
+  for (auto vi : m.vertices()) {
+    const auto& p = m.point(vi);
+    if constexpr (requires { p.approx(); }) {
+      const auto& approx = p.approx();
+      if (!approx.x().is_point() || !approx.y().is_point() || !approx.z().is_point()) {
+        rounded_points.emplace_back(CGAL::to_double(p.x()), CGAL::to_double(p.y()),
+                                    CGAL::to_double(p.z()));
+        rounded.at(vi.idx()) = true;
+        changed_vertices.push_back(vi);
+        continue;
+      }
+    }
+    rounded_points.push_back(p);
+  }
+
+  if (changed_vertices.empty()) {
+    return 0;
+  }
+
+  std::vector<std::vector<Face_index>> vertex_faces(m.num_vertices());
+  for (auto fi : m.faces()) {
+    for (auto vi : m.face(fi)) {
+      if (rounded.at(vi.idx())) {
+        vertex_faces.at(vi.idx()).push_back(fi);
+      }
+    }
+  }
+
+  auto incident_faces = [&](const std::vector<Vertex_index>& vis) {
+    std::vector<Face_index> fis;
+    for (auto vi : vis) {
+      const auto& v_fis = vertex_faces.at(vi.idx());
+      fis.insert(fis.end(), v_fis.begin(), v_fis.end());
+    }
+    std::sort(fis.begin(), fis.end());
+    fis.erase(std::unique(fis.begin(), fis.end()), fis.end());
+    return fis;
+  };
+
+  // A rounded point lies in the interval approximation of the exact point, so the bounding boxes
+  // of the faces of m enclose the faces whichever of their vertices are rounded. The pairs of
+  // faces tested later are among the ones tested here.
+  auto fis = incident_faces(changed_vertices);
+  auto original_defects = internal::defective_face_pairs(
+      m, fis, [&](Vertex_index vi) -> const Point& { return m.point(vi); });
+
+  // Restoring vertices can introduce new defects around them in turn, so repeat until there are
+  // none. Each round restores at least one vertex, as a pair of faces without rounded vertices
+  // is the same as before rounding.
+  auto candidate_point = [&](Vertex_index vi) -> const Point& {
+    return rounded.at(vi.idx()) ? rounded_points.at(vi.idx()) : m.point(vi);
+  };
+  while (!fis.empty()) {
+    changed_vertices.clear();
+    for (const auto& pair : internal::defective_face_pairs(m, fis, candidate_point)) {
+      if (std::binary_search(original_defects.begin(), original_defects.end(), pair)) {
+        continue;
+      }
+      for (auto fi : {pair.first, pair.second}) {
+        for (auto vi : m.face(fi)) {
+          if (rounded.at(vi.idx())) {
+            rounded.at(vi.idx()) = false;
+            changed_vertices.push_back(vi);
+          }
+        }
+      }
+    }
+    fis = incident_faces(changed_vertices);
+  }
+
+  auto num_rounded = static_cast<std::size_t>(std::count(rounded.begin(), rounded.end(), true));
+  if (num_rounded == 0) {
+    return 0;
+  }
+
+  std::vector<Point> points;
+  std::vector<Face> faces;
+  std::vector<FaceData> face_data;
+  points.reserve(m.num_vertices());
+  faces.reserve(m.num_faces());
+  face_data.reserve(m.num_faces());
+  for (auto vi : m.vertices()) {
+    points.push_back(candidate_point(vi));
+  }
+  for (auto fi : m.faces()) {
+    faces.push_back(m.face(fi));
+    face_data.push_back(m.data(fi));
+  }
+
+  m = Triangle_soup<K, FaceData>{std::move(points), std::move(faces), std::move(face_data)};
+  return num_rounded;
+}
+
+}  // namespace kigumi
@@ -2,7 +2,6 @@
 
 #include <CGAL/Kernel/global_functions.h>
 #include <CGAL/enum.h>
-#include <CGAL/intersections.h>
 #include <kigumi/Mesh_indices.h>
 #include <kigumi/Triangle_soup.h>
 #include <kigumi/mesh_utility.h>
@@ -10,7 +9,7 @@
 #include <algorithm>
 #include <iterator>
 #include <stdexcept>
-#include <variant>
+#include <utility>
 #include <vector>
 
 namespace kigumi {
@@ -21,7 +20,6 @@ class Side_of_triangle_soup {
   using Leaf = typename Triangle_soup<K, FaceData>::Leaf;
   using Point = typename K::Point_3;
   using Ray = typename K::Ray_3;
-  using Segment = typename K::Segment_3;
   using Triangle_soup = Triangle_soup<K, FaceData>;
 
  public:
@@ -47,25 +45,49 @@ class Side_of_triangle_soup {
 
       for (const auto* leaf : leaves_) {
         auto fi = leaf->face_index();
-        auto tri = soup.triangle(fi);
+        const auto& f = soup.face(fi);
+        const auto& a = soup.point(f[0]);
+        const auto& b = soup.point(f[1]);
+        const auto& c = soup.point(f[2]);
+
+        // The line through the ray misses the face if the orientations have different signs.
+        auto o1 = CGAL::orientation(p, p_trg, a, b);
+        auto o2 = CGAL::orientation(p, p_trg, b, c);
+        auto o3 = CGAL::orientation(p, p_trg, c, a);
+        if ((o1 > 0 || o2 > 0 || o3 > 0) && (o1 < 0 || o2 < 0 || o3 < 0)) {
+          continue;
+        }
 
-        auto result = CGAL::intersection(tri, ray);
-        if (!result) {
+        if (CGAL::collinear(a, b, c)) {
           continue;
         }
 
-        if (const auto* point = std::get_if<Point>(&*result)) {
-          if (*point == p) {
-            return CGAL::ON_ORIENTED_BOUNDARY;
-          }
-          auto d = CGAL::squared_distance(p, *point);
-          intersections_.emplace_back(std::move(d), fi);
-        } else if (const auto* segment = std::get_if<Segment>(&*result)) {
-          if (segment->source() == p || segment->target() == p) {
+        if (o1 == CGAL::COPLANAR && o2 == CGAL::COPLANAR && o3 == CGAL::COPLANAR) {
+          // The ray lies on the supporting plane of the face.
+          if (CGAL::coplanar_orientation(a, b, c, p) != CGAL::NEGATIVE &&
+              CGAL::coplanar_orientation(b, c, a, p) != CGAL::NEGATIVE &&
+              CGAL::coplanar_orientation(c, a, b, p) != CGAL::NEGATIVE) {
             return CGAL::ON_ORIENTED_BOUNDARY;
           }
           // Ignore.
+          continue;
         }
+
+        // Otherwise, the line crosses the face at a single point.
+        if (CGAL::orientation(a, b, c, p) == CGAL::COPLANAR) {
+          return CGAL::ON_ORIENTED_BOUNDARY;
+        }
+
+        // The parameter of the crossing point along the ray, where p is at 0 and p_trg is at 1.
+        auto vp = CGAL::volume(a, b, c, p);
+        auto vq = CGAL::volume(a, b, c, p_trg);
+        FT t = vp / (vp - vq);
+        if (t < 0) {
+          // The face is behind the ray.
+          continue;
+        }
+
+        intersections_.emplace_back(std::move(t), fi);
       }
 
       if (intersections_.empty()) {
@@ -75,9 +97,9 @@ class Side_of_triangle_soup {
 
       if (intersections_.size() >= 2) {
         std::partial_sort(intersections_.begin(), intersections_.begin() + 2, intersections_.end(),
-                          [](const auto& a, const auto& b) { return a.distance < b.distance; });
+                          [](const auto& a, const auto& b) { return a.t < b.t; });
 
-        if (intersections_.at(0).distance == intersections_.at(1).distance) {
+        if (intersections_.at(0).t == intersections_.at(1).t) {
           // The ray touches or passes through an edge or a vertex shared by two or more triangles.
           continue;
         }
@@ -92,7 +114,7 @@ class Side_of_triangle_soup {
 
  private:
   struct Intersection {
-    FT distance;
+    FT t;
     Face_index fi;
   };
 
@@ -188,11 +188,9 @@ class Triangle_mesh {
   }
 
   Bbox bbox() const {
-    auto bbox_fast = [](const Point& p) -> Bbox { return p.approx().bbox(); };
-
     Bbox bbox;
     for (const auto& p : points_) {
-      bbox += bbox_fast(p);
+      bbox += internal::point_bbox(p);
     }
     return bbox;
   }
@@ -116,12 +116,17 @@ class Triangle_soup {
     return {point(f[0]), point(f[1]), point(f[2])};
   }
 
-  Bbox bbox() const {
-    auto bbox_fast = [](const Point& p) -> Bbox { return p.approx().bbox(); };
+  // Replaces the points with ones without construction history. See internal::flatten_point.
+  void flatten_points() {
+    for (auto& p : points_) {
+      p = internal::flatten_point(p);
+    }
+  }
 
+  Bbox bbox() const {
     Bbox bbox;
     for (const auto& p : points_) {
-      bbox += bbox_fast(p);
+      bbox += internal::point_bbox(p);
     }
     return bbox;
   }
@@ -209,9 +214,10 @@ struct Read<Triangle_soup<K, FaceData>> {
         kigumi_read<CGAL::Exact_rational>(in, x);
         kigumi_read<CGAL::Exact_rational>(in, y);
         kigumi_read<CGAL::Exact_rational>(in, z);
-        t.add_vertex({CGAL::Lazy_exact_nt<CGAL::Exact_rational>{std::move(x)},
-                      CGAL::Lazy_exact_nt<CGAL::Exact_rational>{std::move(y)},
-                      CGAL::Lazy_exact_nt<CGAL::Exact_rational>{std::move(z)}});
+        t.add_vertex(internal::flatten_point(
+            typename K::Point_3{CGAL::Lazy_exact_nt<CGAL::Exact_rational>{std::move(x)},
+                                CGAL::Lazy_exact_nt<CGAL::Exact_rational>{std::move(y)},
+                                CGAL::Lazy_exact_nt<CGAL::Exact_rational>{std::move(z)}}));
       }
     }
 
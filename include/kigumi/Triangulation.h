@@ -1,48 +1,118 @@
 #pragma once
 
-#include <CGAL/Constrained_Delaunay_triangulation_2.h>
+#include <CGAL/Constrained_triangulation_2.h>
 #include <CGAL/Kernel/global_functions.h>
-#include <CGAL/Projection_traits_3.h>
+#include <CGAL/Spatial_sort_traits_adapter_2.h>
 #include <CGAL/Triangulation_vertex_base_with_info_2.h>
+#include <CGAL/number_utils.h>
+#include <CGAL/property_map.h>
+#include <CGAL/spatial_sort.h>
 #include <kigumi/Mesh_indices.h>
 #include <kigumi/Triangle_region.h>
 
+#include <algorithm>
 #include <array>
+#include <boost/container/static_vector.hpp>
 #include <boost/unordered/unordered_flat_map.hpp>
+#include <cmath>
+#include <cstddef>
+#include <optional>
 #include <stdexcept>
+#include <utility>
+#include <vector>
 
 namespace kigumi {
 
+// Retriangulates a face with the points and the constraints inserted into it. An instance can be
+// reset and reused for other faces, so that its buffers are allocated only once per thread.
+//
+// Most faces are crossed by only one or two constraints. Such faces are split combinatorially,
+// using the regions of the points in the face. Other faces are triangulated with a constrained
+// triangulation of the points projected onto the coordinate plane on which the face has the
+// largest area.
 template <class K>
 class Triangulation {
   using Point = typename K::Point_3;
-  using CDT_traits = CGAL::Projection_traits_3<K>;
-  using Vb = CGAL::Triangulation_vertex_base_with_info_2<std::size_t, CDT_traits>;
-  using Fb = CGAL::Constrained_triangulation_face_base_2<CDT_traits>;
+  using Point_2 = typename K::Point_2;
+  using Vb = CGAL::Triangulation_vertex_base_with_info_2<std::size_t, K>;
+  using Fb = CGAL::Constrained_triangulation_face_base_2<K>;
   using Tds = CGAL::Triangulation_data_structure_2<Vb, Fb>;
-  using CDT = CGAL::Constrained_Delaunay_triangulation_2<CDT_traits, Tds>;
+  using CT = CGAL::Constrained_triangulation_2<K, Tds>;
+  using Face_handle = typename CT::Face_handle;
+  using Vertex_handle = typename CT::Vertex_handle;
+  using Projected_point = std::pair<Point_2, std::size_t>;
+  using Spatial_sort_traits =
+      CGAL::Spatial_sort_traits_adapter_2<K, CGAL::First_of_pair_property_map<Projected_point>>;
+
+  struct Input_point {
+    Point p;
+    std::size_t id;
+    // The index of the edge of the face on which the point lies, or -1 if it lies in the face.
+    int ei;
+  };
+
+  using Simple_faces = boost::container::static_vector<std::array<std::size_t, 3>, 4>;
 
  public:
-  using Face_handle = typename CDT::Face_handle;
-  using Intersection_of_constraints_exception = typename CDT::Intersection_of_constraints_exception;
-  using Vertex_handle = typename CDT::Vertex_handle;
+  using Intersection_of_constraints_exception = typename CT::Intersection_of_constraints_exception;
+
+  Triangulation() = default;
 
   Triangulation(Triangle_region f, const Point& pa, const Point& pb, const Point& pc, std::size_t a,
-                std::size_t b, std::size_t c)
-      : f_{f}, cdt_{make_cdt_traits(pa, pb, pc)} {
-    // To keep id_to_vh_ small, we do not insert these vertices into it.
-    vhs_[0] = cdt_.insert_outside_affine_hull(pa);
-    vhs_[0]->info() = a;
-    vhs_[1] = cdt_.insert_outside_affine_hull(pb);
-    vhs_[1]->info() = b;
-    vhs_[2] = cdt_.insert_outside_affine_hull(pc);
-    vhs_[2]->info() = c;
+                std::size_t b, std::size_t c) {
+    reset(f, pa, pb, pc, a, b, c);
+  }
+
+  // Starts over with the face f.
+  void reset(Triangle_region f, const Point& pa, const Point& pb, const Point& pc, std::size_t a,
+             std::size_t b, std::size_t c) {
+    f_ = f;
+    corners_ = {pa, pb, pc};
+    corner_ids_ = {a, b, c};
+    points_.clear();
+    id_to_index_.clear();
+    constraints_.clear();
   }
 
+  // Triangulates the face and writes the faces, which have the same orientation as the face.
   template <class OutputIterator>
-  std::size_t get_faces(OutputIterator faces) const {
+  std::size_t get_faces(OutputIterator faces) {
+    if (auto simple_faces = simple_triangulation()) {
+      for (const auto& [a, b, c] : *simple_faces) {
+        *faces++ = {Vertex_index{a}, Vertex_index{b}, Vertex_index{c}};
+      }
+      return simple_faces->size();
+    }
+
+    auto [i, j] = projection_axes();
+    auto project = [&](const Point& p) { return Point_2{p.cartesian(i), p.cartesian(j)}; };
+
+    projected_points_.clear();
+    for (const auto& point : points_) {
+      projected_points_.emplace_back(project(point.p), point.id);
+    }
+    CGAL::spatial_sort(projected_points_.begin(), projected_points_.end(), Spatial_sort_traits{});
+
+    CT ct;
+    id_to_vh_.clear();
+    for (std::size_t k = 0; k < 3; ++k) {
+      auto vh = ct.insert(project(corners_.at(k)));
+      vh->info() = corner_ids_.at(k);
+      id_to_vh_.emplace(corner_ids_.at(k), vh);
+    }
+    Face_handle hint;
+    for (const auto& [p, id] : projected_points_) {
+      auto vh = ct.insert(p, hint);
+      vh->info() = id;
+      id_to_vh_.emplace(id, vh);
+      hint = vh->face();
+    }
+    for (const auto& [a, b] : constraints_) {
+      ct.insert_constraint(id_to_vh_.at(a), id_to_vh_.at(b));
+    }
+
     std::size_t count{};
-    for (auto it = cdt_.finite_faces_begin(); it != cdt_.finite_faces_end(); ++it) {
+    for (auto it = ct.finite_faces_begin(); it != ct.finite_faces_end(); ++it) {
       auto a = Vertex_index{it->vertex(0)->info()};
       auto b = Vertex_index{it->vertex(1)->info()};
       auto c = Vertex_index{it->vertex(2)->info()};
@@ -52,89 +122,162 @@ class Triangulation {
     return count;
   }
 
-  Vertex_handle insert(const Point& p, std::size_t id, Triangle_region region) {
+  // Inserts the point and returns the id of the vertex at the point.
+  std::size_t insert(const Point& p, std::size_t id, Triangle_region region) {
     switch (intersection(region, f_)) {
       case Triangle_region::LEFT_VERTEX_0:
       case Triangle_region::RIGHT_VERTEX_0:
-        return vhs_[0];
+        return corner_ids_[0];
 
       case Triangle_region::LEFT_VERTEX_1:
       case Triangle_region::RIGHT_VERTEX_1:
-        return vhs_[1];
+        return corner_ids_[1];
 
       case Triangle_region::LEFT_VERTEX_2:
       case Triangle_region::RIGHT_VERTEX_2:
-        return vhs_[2];
+        return corner_ids_[2];
 
       case Triangle_region::LEFT_EDGE_01:
       case Triangle_region::RIGHT_EDGE_01:
-        return insert_in_edge(p, id, 0);
+        return insert_point(p, id, 0);
 
       case Triangle_region::LEFT_EDGE_12:
       case Triangle_region::RIGHT_EDGE_12:
-        return insert_in_edge(p, id, 1);
+        return insert_point(p, id, 1);
 
       case Triangle_region::LEFT_EDGE_20:
       case Triangle_region::RIGHT_EDGE_20:
-        return insert_in_edge(p, id, 2);
+        return insert_point(p, id, 2);
 
       case Triangle_region::LEFT_FACE:
       case Triangle_region::RIGHT_FACE:
-        return insert_in_face(p, id);
+        return insert_point(p, id, -1);
 
       default:
         throw std::runtime_error("invalid region");
     }
   }
 
-  void insert_constraint(Vertex_handle vh_i, Vertex_handle vh_j) {
-    cdt_.insert_constraint(vh_i, vh_j);
+  // Inserts the constraint between the vertices with the ids returned by insert.
+  void insert_constraint(std::size_t i, std::size_t j) {
+    constraints_.emplace_back(std::min(i, j), std::max(i, j));
   }
 
  private:
-  Vertex_handle insert_in_edge(const Point& p, std::size_t id, int ei) {
-    auto [it, inserted] = id_to_vh_.emplace(id, Vertex_handle{});
-
-    if (inserted) {
-      Vertex_handle vh;
-      Face_handle fh;
-      if (cdt_.is_edge(vhs_.at(ei), vhs_.at((ei + 1) % 3), fh, ei)) {
-        vh = cdt_.insert(p, CDT::EDGE, fh, ei);
-      } else {
-        vh = cdt_.insert(p);
-      }
-      vh->info() = id;
-      it->second = vh;
+  std::size_t insert_point(const Point& p, std::size_t id, int ei) {
+    if (id_to_index_.emplace(id, points_.size()).second) {
+      points_.push_back({p, id, ei});
     }
-
-    return it->second;
+    return id;
   }
 
-  Vertex_handle insert_in_face(const Point& p, std::size_t id) {
-    auto [it, inserted] = id_to_vh_.emplace(id, Vertex_handle{});
+  // Returns the faces of the triangulation of the corners and the points, or std::nullopt if
+  // the configuration is not supported or a constraint is not an edge of the triangulation.
+  std::optional<Simple_faces> simple_triangulation() const {
+    auto corner = [&](int i) { return corner_ids_.at(static_cast<std::size_t>(i % 3)); };
 
-    if (inserted) {
-      Vertex_handle vh;
-      Face_handle fh;
-      if (cdt_.is_face(vhs_[0], vhs_[1], vhs_[2], fh)) {
-        vh = cdt_.insert(p, CDT::FACE, fh, -1);
+    Simple_faces faces;
+    if (points_.empty()) {
+      faces.push_back(corner_ids_);
+    } else if (points_.size() == 1) {
+      const auto& m = points_[0];
+      if (m.ei < 0) {
+        for (auto i = 0; i < 3; ++i) {
+          faces.push_back({corner(i), corner(i + 1), m.id});
+        }
       } else {
-        vh = cdt_.insert(p);
+        auto i = m.ei;
+        faces.push_back({corner(i), m.id, corner(i + 2)});
+        faces.push_back({m.id, corner(i + 1), corner(i + 2)});
       }
-      vh->info() = id;
-      it->second = vh;
+    } else if (points_.size() == 2) {
+      const auto* m = &points_[0];
+      const auto* n = &points_[1];
+      if (m->ei < 0) {
+        std::swap(m, n);
+      }
+      if (m->ei < 0 || m->ei == n->ei) {
+        return std::nullopt;
+      }
+      if (n->ei < 0) {
+        // Split the face at n, and the face that contains m at m.
+        auto i = m->ei;
+        faces.push_back({corner(i), m->id, n->id});
+        faces.push_back({m->id, corner(i + 1), n->id});
+        faces.push_back({corner(i + 1), corner(i + 2), n->id});
+        faces.push_back({corner(i + 2), corner(i), n->id});
+      } else {
+        if (n->ei != (m->ei + 1) % 3) {
+          std::swap(m, n);
+        }
+        // Cut off the corner between the edges, and split the remaining convex quadrilateral
+        // by one of the diagonals.
+        auto i = m->ei;
+        faces.push_back({m->id, corner(i + 1), n->id});
+        if (has_constraint(corner(i), n->id)) {
+          faces.push_back({corner(i), m->id, n->id});
+          faces.push_back({corner(i), n->id, corner(i + 2)});
+        } else {
+          faces.push_back({corner(i), m->id, corner(i + 2)});
+          faces.push_back({m->id, n->id, corner(i + 2)});
+        }
+      }
+    } else {
+      return std::nullopt;
     }
 
-    return it->second;
+    for (const auto& constraint : constraints_) {
+      auto is_edge = std::any_of(faces.begin(), faces.end(), [&](const auto& f) {
+        return std::find(f.begin(), f.end(), constraint.first) != f.end() &&
+               std::find(f.begin(), f.end(), constraint.second) != f.end();
+      });
+      if (!is_edge) {
+        return std::nullopt;
+      }
+    }
+
+    return faces;
+  }
+
+  bool has_constraint(std::size_t i, std::size_t j) const {
+    std::pair constraint{std::min(i, j), std::max(i, j)};
+    return std::find(constraints_.begin(), constraints_.end(), constraint) != constraints_.end();
   }
 
-  static CDT_traits make_cdt_traits(const Point& pa, const Point& pb, const Point& pc) {
-    return CDT_traits{CGAL::normal(pa, pb, pc)};
+  // Returns the axes of the coordinate plane onto which the face is projected. The axis along
+  // which the normal has the largest component is dropped, and the others are ordered so that
+  // the projection preserves the orientation of the face.
+  std::pair<int, int> projection_axes() const {
+    const auto& [pa, pb, pc] = corners_;
+    auto n = CGAL::normal(pa, pb, pc);
+
+    auto axis = 0;
+    auto max = -1.0;
+    for (auto k = 0; k < 3; ++k) {
+      auto x = std::abs(CGAL::to_double(n.cartesian(k)));
+      if (x > max) {
+        axis = k;
+        max = x;
+      }
+    }
+    auto sign = CGAL::sign(n.cartesian(axis));
+    for (auto k = 0; k < 3 && sign == CGAL::ZERO; ++k) {
+      axis = k;
+      sign = CGAL::sign(n.cartesian(axis));
+    }
+
+    auto i = (axis + 1) % 3;
+    auto j = (axis + 2) % 3;
+    return sign == CGAL::NEGATIVE ? std::pair{j, i} : std::pair{i, j};
   }
 
   Triangle_region f_{};
-  CDT cdt_;
-  std::array<Vertex_handle, 3> vhs_;
+  std::array<Point, 3> corners_;
+  std::array<std::size_t, 3> corner_ids_{};
+  std::vector<Input_point> points_;
+  boost::unordered_flat_map<std::size_t, std::size_t> id_to_index_;
+  std::vector<std::pair<std::size_t, std::size_t>> constraints_;
+  std::vector<Projected_point> projected_points_;
   boost::unordered_flat_map<std::size_t, Vertex_handle> id_to_vh_;
 };
 
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <CGAL/Bbox_3.h>
+#include <kigumi/parallel_do.h>
+#include <kigumi/parallel_sort.h>
+
+#include <algorithm>
+#include <array>
+#include <boost/iterator/counting_iterator.hpp>
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace kigumi {
+
+// A uniform grid over a box-shaped domain whose non-empty cells are stored in a hash map.
+//
+// Each leaf is registered to every cell its bounding box overlaps. Leaves and queries that stick
+// out of the domain are clamped to the boundary cells. A query reports a leaf only from the cell
+// that contains the minimum corner of the intersection of the two boxes, so each intersecting
+// leaf is reported exactly once.
+//
+// A leaf that overlaps more than kMaxCellsPerLeaf cells, e.g., a large ground plane under a
+// detailed model, is not registered to the cells but tested against every query instead.
+template <class Leaf>
+class Uniform_grid {
+  using Bbox = CGAL::Bbox_3;
+  using Cell = std::array<std::size_t, 3>;
+  using Cell_key = std::uint64_t;
+  using Entry = std::pair<Cell_key, std::size_t>;
+  using Entry_range = std::pair<std::size_t, std::size_t>;
+
+  static constexpr std::size_t kMaxCellsPerLeaf = 64;
+
+ public:
+  Uniform_grid(std::vector<Leaf> leaves, const Bbox& domain)
+      : leaves_{std::move(leaves)}, domain_{domain} {
+    if (leaves_.empty()) {
+      return;
+    }
+
+    set_resolution();
+
+    std::vector<Entry> entries;
+    parallel_do(
+        boost::counting_iterator<std::size_t>(0),
+        boost::counting_iterator<std::size_t>(leaves_.size()),
+        std::pair<std::vector<Entry>, std::vector<std::size_t>>{},
+        [&](std::size_t i, auto& local_state) {
+          auto& [local_entries, local_large_leaf_indices] = local_state;
+          auto [lo, hi] = cell_range(leaves_.at(i).bbox());
+          if (count_cells(lo, hi) > kMaxCellsPerLeaf) {
+            local_large_leaf_indices.push_back(i);
+            return;
+          }
+          for (auto z = lo[2]; z <= hi[2]; ++z) {
+            for (auto y = lo[1]; y <= hi[1]; ++y) {
+              for (auto x = lo[0]; x <= hi[0]; ++x) {
+                local_entries.emplace_back(cell_key({x, y, z}), i);
+              }
+            }
+          }
+        },
+        [&](auto& local_state) {
+          auto& [local_entries, local_large_leaf_indices] = local_state;
+          if (entries.empty()) {
+            entries = std::move(local_entries);
+          } else {
+            entries.insert(entries.end(), local_entries.begin(), local_entries.end());
+          }
+          large_leaf_indices_.insert(large_leaf_indices_.end(), local_large_leaf_indices.begin(),
+                                     local_large_leaf_indices.end());
+        });
+
+    parallel_sort(entries.begin(), entries.end());
+    std::sort(large_leaf_indices_.begin(), large_leaf_indices_.end());
+
+    leaf_indices_.reserve(entries.size());
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+      auto key = entries.at(i).first;
+      if (i == 0 || key != entries.at(i - 1).first) {
+        cells_.emplace(key, Entry_range{i, i});
+      }
+      ++cells_.at(key).second;
+      leaf_indices_.push_back(entries.at(i).second);
+    }
+  }
+
+  template <class OutputIterator>
+  void get_intersecting_leaves(OutputIterator leaves, const Bbox& query) const {
+    if (leaves_.empty()) {
+      return;
+    }
+
+    for (auto i : large_leaf_indices_) {
+      const auto& leaf = leaves_.at(i);
+      if (CGAL::do_overlap(leaf.bbox(), query)) {
+        *leaves++ = &leaf;
+      }
+    }
+
+    auto report = [&](const Cell& cell, const Entry_range& range) {
+      auto [first, last] = range;
+      for (auto j = first; j < last; ++j) {
+        const auto& leaf = leaves_.at(leaf_indices_.at(j));
+        const auto& bbox = leaf.bbox();
+        if (!CGAL::do_overlap(bbox, query)) {
+          continue;
+        }
+
+        // Report the leaf only from one of the cells shared by the two boxes.
+        auto reference_cell =
+            cell_of({std::max(bbox.xmin(), query.xmin()), std::max(bbox.ymin(), query.ymin()),
+                     std::max(bbox.zmin(), query.zmin())});
+        if (reference_cell != cell) {
+          continue;
+        }
+
+        *leaves++ = &leaf;
+      }
+    };
+
+    auto [lo, hi] = cell_range(query);
+    if (count_cells(lo, hi) > cells_.size()) {
+      // A large query visits the non-empty cells instead of all the cells it overlaps.
+      for (const auto& [key, range] : cells_) {
+        auto cell = cell_of_key(key);
+        if (cell[0] >= lo[0] && cell[0] <= hi[0] && cell[1] >= lo[1] && cell[1] <= hi[1] &&
+            cell[2] >= lo[2] && cell[2] <= hi[2]) {
+          report(cell, range);
+        }
+      }
+      return;
+    }
+
+    for (auto z = lo[2]; z <= hi[2]; ++z) {
+      for (auto y = lo[1]; y <= hi[1]; ++y) {
+        for (auto x = lo[0]; x <= hi[0]; ++x) {
+          Cell cell{x, y, z};
+          auto it = cells_.find(cell_key(cell));
+          if (it != cells_.end()) {
+            report(cell, it->second);
+          }
+        }
+      }
+    }
+  }
+
+  std::size_t num_cells() const { return cells_.size(); }
+
+ private:
+  // Chooses the cell size so that a cell is as large as an average leaf.
+  void set_resolution() {
+    static constexpr std::size_t kMaxResolution = std::size_t{1} << 20;
+
+    std::array<double, 3> extent{domain_.xmax() - domain_.xmin(), domain_.ymax() - domain_.ymin(),
+                                 domain_.zmax() - domain_.zmin()};
+    auto max_extent = std::max({extent[0], extent[1], extent[2]});
+
+    double mean_leaf_extent{};
+    for (const auto& leaf : leaves_) {
+      const auto& bbox = leaf.bbox();
+      mean_leaf_extent += std::max({bbox.xmax() - bbox.xmin(), bbox.ymax() - bbox.ymin(),
+                                    bbox.zmax() - bbox.zmin()});
+    }
+    mean_leaf_extent /= static_cast<double>(leaves_.size());
+
+    if (!(mean_leaf_extent > 0.0)) {
+      // All leaves are degenerate. Aim at a constant number of leaves per cell.
+      mean_leaf_extent = max_extent / std::cbrt(static_cast<double>(leaves_.size()));
+    }
+
+    for (std::size_t i = 0; i < 3; ++i) {
+      auto n = extent.at(i) > 0.0 ? std::ceil(extent.at(i) / mean_leaf_extent) : 1.0;
+      resolution_.at(i) =
+          static_cast<std::size_t>(std::clamp(n, 1.0, static_cast<double>(kMaxResolution)));
+      inv_cell_size_.at(i) =
+          extent.at(i) > 0.0 ? static_cast<double>(resolution_.at(i)) / extent.at(i) : 0.0;
+    }
+  }
+
+  std::size_t cell_coordinate(double x, std::size_t axis) const {
+    auto t = (x - domain_.min(static_cast<int>(axis))) * inv_cell_size_.at(axis);
+    if (!(t > 0.0)) {
+      return 0;
+    }
+    return std::min(static_cast<std::size_t>(t), resolution_.at(axis) - 1);
+  }
+
+  Cell cell_of(const std::array<double, 3>& p) const {
+    return {cell_coordinate(p[0], 0), cell_coordinate(p[1], 1), cell_coordinate(p[2], 2)};
+  }
+
+  std::pair<Cell, Cell> cell_range(const Bbox& bbox) const {
+    return {cell_of({bbox.xmin(), bbox.ymin(), bbox.zmin()}),
+            cell_of({bbox.xmax(), bbox.ymax(), bbox.zmax()})};
+  }
+
+  static std::size_t count_cells(const Cell& lo, const Cell& hi) {
+    return (hi[0] - lo[0] + 1) * (hi[1] - lo[1] + 1) * (hi[2] - lo[2] + 1);
+  }
+
+  Cell cell_of_key(Cell_key key) const {
+    auto x = static_cast<std::size_t>(key % resolution_[0]);
+    key /= resolution_[0];
+    auto y = static_cast<std::size_t>(key % resolution_[1]);
+    auto z = static_cast<std::size_t>(key / resolution_[1]);
+    return {x, y, z};
+  }
+
+  Cell_key cell_key(const Cell& cell) const {
+    return static_cast<Cell_key>(cell[0]) +
+           static_cast<Cell_key>(resolution_[0]) *
+               (static_cast<Cell_key>(cell[1]) +
+                static_cast<Cell_key>(resolution_[1]) * static_cast<Cell_key>(cell[2]));
+  }
+
+  std::vector<Leaf> leaves_;
+  Bbox domain_;
+  std::array<std::size_t, 3> resolution_{1, 1, 1};
+  std::array<double, 3> inv_cell_size_{};
+  boost::unordered_flat_map<Cell_key, Entry_range> cells_;
+  std::vector<std::size_t> leaf_indices_;
+  std::vector<std::size_t> large_leaf_indices_;
+};
+
+}  // namespace kigumi
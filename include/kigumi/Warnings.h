@@ -8,6 +8,8 @@ enum class Warnings : std::uint8_t {
   NONE = 0,
   FIRST_MESH_PARTIALLY_INTERSECTS_WITH_SECOND_MESH = 1,
   SECOND_MESH_PARTIALLY_INTERSECTS_WITH_FIRST_MESH = 2,
+  // The intersection points are rounded to doubles. See Boolean_options::inexact_mode.
+  INEXACT_INTERSECTION_POINTS = 4,
 };
 
 inline Warnings operator|(Warnings a, Warnings b) {
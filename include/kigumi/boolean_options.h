@@ -0,0 +1,50 @@
+#pragma once
+
+#include <kigumi/Context.h>
+
+#include <cstdint>
+
+namespace kigumi {
+
+enum class Broad_phase_strategy : std::uint8_t {
+  // Choose the strategy, the mesh to build the index over, and the number of threads
+  // with a cost model estimated from the inputs.
+  AUTOMATIC,
+  // Query a bounding volume hierarchy built over the faces of one mesh.
+  AABB_TREE,
+  // Query a hashed uniform grid built over the overlap of the two meshes.
+  // Suited for meshes with fairly uniform triangle sizes.
+  UNIFORM_GRID,
+};
+
+class Boolean_options {
+ public:
+  Broad_phase_strategy broad_phase_strategy() const { return broad_phase_strategy_; }
+
+  void set_broad_phase_strategy(Broad_phase_strategy strategy) {
+    broad_phase_strategy_ = strategy;
+  }
+
+  // If true, the meshes are first mixed with the coordinates rounded to doubles, which is
+  // faster but inexact, and mixed again exactly only if the result fails the consistency checks.
+  // Boolean_region_builder::warnings includes Warnings::INEXACT_INTERSECTION_POINTS if the inexact
+  // result is used.
+  bool inexact_mode() const { return inexact_mode_; }
+
+  void set_inexact_mode(bool inexact_mode) { inexact_mode_ = inexact_mode; }
+
+  // If true, the vertices of the results are rounded to doubles where it does not make faces
+  // degenerate or intersecting. See round_vertices.
+  bool round_result() const { return round_result_; }
+
+  void set_round_result(bool round_result) { round_result_ = round_result; }
+
+ private:
+  Broad_phase_strategy broad_phase_strategy_{Broad_phase_strategy::AUTOMATIC};
+  bool inexact_mode_{};
+  bool round_result_{};
+};
+
+using Boolean_context = Context<Boolean_options>;
+
+}  // namespace kigumi
@@ -5,6 +5,8 @@
 #include <CGAL/enum.h>
 #include <kigumi/Mesh_indices.h>
 
+#include <optional>
+
 namespace kigumi {
 
 template <class K, class FaceData>
@@ -17,12 +19,48 @@ namespace internal {
 
 // Facilities for avoiding construction of intermediate kernel objects.
 
+// Returns the bounding box of the point, from its interval approximation for lazy kernels.
+template <class Point>
+CGAL::Bbox_3 point_bbox(const Point& p) {
+  if constexpr (requires { p.approx(); }) {
+    return p.approx().bbox();
+  } else {
+    return p.bbox();
+  }
+}
+
+// Returns a copy of the point that holds only its exact value and its approximation, which
+// releases the construction history (the DAG) of a lazy-exact point and its evaluated nodes.
+template <class Point>
+Point flatten_point(const Point& p) {
+  if constexpr (requires { p.exact(); }) {
+    const auto& approx = p.approx();
+    if (approx.x().is_point() && approx.y().is_point() && approx.z().is_point()) {
+      return Point{approx.x().inf(), approx.y().inf(), approx.z().inf()};
+    }
+    return Point{typename Point::Rep{p.exact()}};
+  } else {
+    return p;
+  }
+}
+
+// Returns whether the exact value of a lazy-exact point has been computed, or std::nullopt if
+// the representation does not expose it. Returns true for non-lazy kernels.
+template <class Point>
+std::optional<bool> has_exact_value(const Point& p) {
+  if constexpr (requires { p.ptr()->is_lazy(); }) {
+    return !p.ptr()->is_lazy();
+  } else if constexpr (requires { p.exact(); }) {
+    return std::nullopt;
+  } else {
+    return true;
+  }
+}
+
 template <class K, class FaceData>
 CGAL::Bbox_3 face_bbox(const Triangle_soup<K, FaceData>& m, Face_index fi) {
-  auto bbox_fast = [](const typename K::Point_3& p) -> CGAL::Bbox_3 { return p.approx().bbox(); };
-
   const auto& f = m.face(fi);
-  return bbox_fast(m.point(f[0])) + bbox_fast(m.point(f[1])) + bbox_fast(m.point(f[2]));
+  return point_bbox(m.point(f[0])) + point_bbox(m.point(f[1])) + point_bbox(m.point(f[2]));
 }
 
 template <class K, class FaceData>
@@ -0,0 +1,57 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <gtest/gtest.h>
+#include <kigumi/Expansion.h>
+#include <kigumi/Point_list.h>
+
+#include <array>
+#include <limits>
+#include <random>
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Point = K::Point_3;
+using Point_2 = K::Point_2;
+using kigumi::internal::Double_point;
+using kigumi::internal::expansion_orientation;
+using kigumi::internal::expansion_orientation_2;
+
+TEST(ExpansionTest, Orientation) {
+  std::mt19937 gen{0};
+  std::uniform_real_distribution<double> dist{-1.0, 1.0};
+
+  for (auto i = 0; i < 10000; ++i) {
+    std::array<Double_point, 4> v{};
+    for (auto& p : v) {
+      for (auto& x : p) {
+        x = dist(gen);
+      }
+    }
+    if (i % 2 == 0) {
+      // Make the points nearly coplanar, which the rounding errors decide.
+      auto s = dist(gen);
+      auto t = dist(gen);
+      for (std::size_t j = 0; j < 3; ++j) {
+        v[3].at(j) = v[0].at(j) + s * (v[1].at(j) - v[0].at(j)) + t * (v[2].at(j) - v[0].at(j));
+      }
+    }
+
+    std::array<Point, 4> p;
+    for (std::size_t j = 0; j < 4; ++j) {
+      p.at(j) = Point{v.at(j)[0], v.at(j)[1], v.at(j)[2]};
+    }
+
+    auto o = expansion_orientation(v[0], v[1], v[2], v[3]);
+    ASSERT_TRUE(o);
+    ASSERT_EQ(*o, CGAL::orientation(p[0], p[1], p[2], p[3]));
+
+    auto o2 = expansion_orientation_2(v[0], v[1], v[3], 0, 2);
+    ASSERT_TRUE(o2);
+    ASSERT_EQ(*o2, CGAL::orientation(Point_2{v[0][0], v[0][2]}, Point_2{v[1][0], v[1][2]},
+                                     Point_2{v[3][0], v[3][2]}));
+  }
+
+  auto nan = std::numeric_limits<double>::quiet_NaN();
+  ASSERT_FALSE(expansion_orientation({nan, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0},
+                                     {0.0, 0.0, 1.0}));
+  ASSERT_FALSE(expansion_orientation({0x1p-400, 0.0, 0.0}, {1.0, 0.0, 0.0}, {0.0, 1.0, 0.0},
+                                     {0.0, 0.0, 1.0}));
+}
@@ -0,0 +1,206 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <CGAL/Exact_predicates_inexact_constructions_kernel.h>
+#include <CGAL/Exact_rational.h>
+#include <CGAL/Simple_cartesian.h>
+#include <CGAL/intersections.h>
+#include <gtest/gtest.h>
+#include <kigumi/Face_face_filter.h>
+#include <kigumi/Point_list.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Face_face_filter = kigumi::Face_face_filter<K>;
+using Point_list = kigumi::Point_list<K>;
+using Triangle = K::Triangle_3;
+
+TEST(FaceFaceFilterTest, Separated) {
+  Point_list points;
+  std::array abc{
+      points.insert({0.0, 0.0, 0.0}),
+      points.insert({3.0, 0.0, 0.0}),
+      points.insert({0.0, 3.0, 0.0}),
+  };
+  std::array pqr{
+      points.insert({0.0, 0.0, 1.0}),
+      points.insert({3.0, 0.0, 1.0}),
+      points.insert({0.0, 3.0, 2.0}),
+  };
+
+  Face_face_filter filter{points};
+  ASSERT_TRUE(filter(abc[0], abc[1], abc[2], pqr[0], pqr[1], pqr[2]));
+}
+
+TEST(FaceFaceFilterTest, SeparatedByTheOtherPlane) {
+  Point_list points;
+  std::array abc{
+      points.insert({0.0, 0.0, 0.0}),
+      points.insert({3.0, 0.0, 0.0}),
+      points.insert({0.0, 3.0, 0.0}),
+  };
+  std::array pqr{
+      points.insert({2.0, 2.0, -1.0}),
+      points.insert({5.0, 2.0, -1.0}),
+      points.insert({2.0, 2.0, 2.0}),
+  };
+
+  Face_face_filter filter{points};
+  ASSERT_TRUE(filter(abc[0], abc[1], abc[2], pqr[0], pqr[1], pqr[2]));
+}
+
+TEST(FaceFaceFilterTest, Touching) {
+  Point_list points;
+  std::array abc{
+      points.insert({0.0, 0.0, 0.0}),
+      points.insert({3.0, 0.0, 0.0}),
+      points.insert({0.0, 3.0, 0.0}),
+  };
+  std::array pqr{
+      points.insert({0.0, 1.0, -3.0}),
+      points.insert({3.0, 1.0, -3.0}),
+      points.insert({0.0, 1.0, 0.0}),
+  };
+
+  Face_face_filter filter{points};
+  ASSERT_FALSE(filter(abc[0], abc[1], abc[2], pqr[0], pqr[1], pqr[2]));
+}
+
+TEST(FaceFaceFilterTest, InexactPoint) {
+  Point_list points;
+  std::array abc{
+      points.insert({0.0, 0.0, 0.0}),
+      points.insert({3.0, 0.0, 0.0}),
+      points.insert({0.0, 3.0, 0.0}),
+  };
+  std::array pqr{
+      points.insert({K::FT{1} / 3, K::FT{0}, K::FT{1}}),
+      points.insert({3.0, 0.0, 1.0}),
+      points.insert({0.0, 3.0, 2.0}),
+  };
+  ASSERT_TRUE(points.is_double_point(abc[0]));
+  ASSERT_FALSE(points.is_double_point(pqr[0]));
+
+  Face_face_filter filter{points};
+  ASSERT_FALSE(filter(abc[0], abc[1], abc[2], pqr[0], pqr[1], pqr[2]));
+}
+
+TEST(FaceFaceFilterTest, ToDoublePoint) {
+  using Inexact_kernel = CGAL::Exact_predicates_inexact_constructions_kernel;
+  using Rational_kernel = CGAL::Simple_cartesian<CGAL::Exact_rational>;
+  using kigumi::internal::to_double_point;
+
+  kigumi::internal::Double_point p;
+  ASSERT_TRUE(to_double_point(Inexact_kernel::Point_3{0.1, 0.2, 0.3}, p));
+  ASSERT_EQ(p, (kigumi::internal::Double_point{0.1, 0.2, 0.3}));
+
+  ASSERT_TRUE(to_double_point(Rational_kernel::Point_3{0.5, 0.25, 2.0}, p));
+  ASSERT_EQ(p, (kigumi::internal::Double_point{0.5, 0.25, 2.0}));
+  ASSERT_FALSE(to_double_point(
+      Rational_kernel::Point_3{CGAL::Exact_rational{1} / 3, CGAL::Exact_rational{0},
+                               CGAL::Exact_rational{0}},
+      p));
+
+  ASSERT_FALSE(
+      to_double_point(CGAL::midpoint(K::Point_3{0.1, 0.0, 0.0}, K::Point_3{0.2, 0.0, 0.0}), p));
+}
+
+TEST(FaceFaceFilterTest, Random) {
+  std::mt19937 gen{0};
+  std::uniform_int_distribution<int> dist{-4, 4};
+
+  for (auto i = 0; i < 10000; ++i) {
+    Point_list points;
+    std::array<std::size_t, 6> ids{};
+    for (auto& id : ids) {
+      id = points.insert({dist(gen), dist(gen), dist(gen)});
+    }
+
+    Triangle abc{points.at(ids[0]), points.at(ids[1]), points.at(ids[2])};
+    Triangle pqr{points.at(ids[3]), points.at(ids[4]), points.at(ids[5])};
+    if (abc.is_degenerate() || pqr.is_degenerate()) {
+      continue;
+    }
+
+    Face_face_filter filter{points};
+    if (filter(ids[0], ids[1], ids[2], ids[3], ids[4], ids[5])) {
+      ASSERT_FALSE(CGAL::do_intersect(abc, pqr));
+    }
+  }
+}
+
+TEST(FaceFaceFilterTest, Batch) {
+  std::mt19937 gen{0};
+  std::uniform_int_distribution<int> dist{-4, 4};
+
+  Point_list points;
+  for (auto i = 0; i < 1000; ++i) {
+    points.insert({dist(gen), dist(gen), dist(gen)});
+  }
+
+  std::uniform_int_distribution<std::size_t> id_dist{0, points.size() - 1};
+  std::vector<Face_face_filter::Face_pair> pairs(1001);
+  for (auto& ids : pairs) {
+    for (auto& id : ids) {
+      id = id_dist(gen);
+    }
+  }
+
+  Face_face_filter filter{points};
+  std::vector<Face_face_filter::Signs> signs;
+  filter(pairs, signs);
+  ASSERT_EQ(signs.size(), pairs.size());
+
+  for (std::size_t i = 0; i < pairs.size(); ++i) {
+    const auto& ids = pairs.at(i);
+    const auto& s = signs.at(i);
+    for (std::size_t j = 0; j < 3; ++j) {
+      if (s.at(j) != 0) {
+        ASSERT_EQ(s.at(j), CGAL::orientation(points.at(ids[3]), points.at(ids[4]),
+                                             points.at(ids[5]), points.at(ids.at(j))));
+      }
+      if (s.at(3 + j) != 0) {
+        ASSERT_EQ(s.at(3 + j), CGAL::orientation(points.at(ids[0]), points.at(ids[1]),
+                                                 points.at(ids[2]), points.at(ids.at(3 + j))));
+      }
+    }
+    ASSERT_EQ(Face_face_filter::is_separated(s),
+              filter(ids[0], ids[1], ids[2], ids[3], ids[4], ids[5]));
+  }
+}
+
+TEST(FaceFaceFilterTest, CertifiedOrientations) {
+  std::mt19937 gen{0};
+  std::uniform_real_distribution<double> dist{-1.0, 1.0};
+  auto random_point = [&]() -> kigumi::internal::Double_point {
+    return {dist(gen), dist(gen), dist(gen)};
+  };
+
+  // The number of predicates is not a multiple of the number of lanes, so that both the vector
+  // and the scalar loops are exercised if the filter is compiled with AVX2 or AVX-512.
+  kigumi::internal::Orientation_3_batch batch;
+  for (auto i = 0; i < 1003; ++i) {
+    auto p = random_point();
+    auto q = random_point();
+    auto r = random_point();
+    // Every third point is nearly coplanar with p, q, and r.
+    auto s = i % 3 == 0 ? kigumi::internal::Double_point{(p[0] + q[0] + r[0]) / 3.0,
+                                                         (p[1] + q[1] + r[1]) / 3.0,
+                                                         (p[2] + q[2] + r[2]) / 3.0}
+                        : random_point();
+    batch.push_back(p, q, r, s);
+  }
+
+  std::vector<std::int8_t> signs;
+  kigumi::internal::certified_orientations(batch, signs);
+  ASSERT_EQ(signs.size(), batch.size());
+
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    auto o = kigumi::internal::certified_orientation(batch.at(0, i), batch.at(1, i),
+                                                     batch.at(2, i), batch.at(3, i));
+    ASSERT_EQ(signs.at(i), static_cast<std::int8_t>(o.value_or(CGAL::ZERO)));
+  }
+}
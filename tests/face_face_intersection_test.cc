@@ -335,6 +335,40 @@ TEST(FaceFaceIntersectionTest, CoplanarVertexVertex) {
   ASSERT_TRUE(test(points, abc, pqr));
 }
 
+TEST(FaceFaceIntersectionTest, CoplanarVertical) {
+  // The xy projection is degenerate.
+  Point_list points;
+  std::array abc{
+      points.insert({1.0, 0.0, 0.0}),
+      points.insert({1.0, 3.0, 0.0}),
+      points.insert({1.0, 0.0, 3.0}),
+  };
+  std::array pqr{
+      points.insert({1.0, 2.0, 2.0}),
+      points.insert({1.0, -1.0, 2.0}),
+      points.insert({1.0, 2.0, -1.0}),
+  };
+
+  ASSERT_TRUE(test(points, abc, pqr));
+}
+
+TEST(FaceFaceIntersectionTest, CoplanarTilted) {
+  // CoplanarEdgeEdge mapped onto the plane z = 2x - y.
+  Point_list points;
+  std::array abc{
+      points.insert({0.0, 0.0, 0.0}),
+      points.insert({3.0, 0.0, 6.0}),
+      points.insert({0.0, 3.0, -3.0}),
+  };
+  std::array pqr{
+      points.insert({2.0, 2.0, 2.0}),
+      points.insert({-1.0, 2.0, -4.0}),
+      points.insert({2.0, -1.0, 5.0}),
+  };
+
+  ASSERT_TRUE(test(points, abc, pqr));
+}
+
 TEST(FaceFaceIntersectionTest, CubeCoplanar) {
   Point_list points;
   auto cube = make_cube(points, {0.0, 0.0, 0.0}, {1.0, 1.0, 1.0});
@@ -358,6 +392,44 @@ TEST(FaceFaceIntersectionTest, CubeOpposite) {
   }
 }
 
+TEST(FaceFaceIntersectionTest, CubeTouchesOnlyAtSharedVertices) {
+  Point_list points;
+  auto cube = make_cube(points, {0.0, 0.0, 0.0}, {1.0, 1.0, 1.0});
+
+  Face_face_intersection face_face{points};
+  for (const auto& left_face : cube) {
+    for (const auto& right_face : cube) {
+      if (left_face == right_face) {
+        continue;
+      }
+      auto [a, b, c] = left_face;
+      auto [p, q, r] = right_face;
+      auto shared = std::count_if(left_face.begin(), left_face.end(), [&](auto v) {
+        return std::find(right_face.begin(), right_face.end(), v) != right_face.end();
+      });
+      ASSERT_EQ(face_face.touches_only_at_shared_vertices(a, b, c, p, q, r), shared > 0);
+    }
+  }
+}
+
+TEST(FaceFaceIntersectionTest, NotTouchesOnlyAtSharedVertices) {
+  Point_list points;
+  auto a = points.insert({0.0, 0.0, 0.0});
+  auto b = points.insert({3.0, 0.0, 0.0});
+  auto c = points.insert({0.0, 3.0, 0.0});
+  auto d = points.insert({1.0, 1.0, 0.0});
+  auto e = points.insert({1.0, 1.0, -1.0});
+  auto f = points.insert({1.0, 1.0, 1.0});
+
+  Face_face_intersection face_face{points};
+  // Coplanar faces on the same side of the shared edge.
+  ASSERT_FALSE(face_face.touches_only_at_shared_vertices(a, b, c, b, a, d));
+  ASSERT_TRUE(test(points, {a, b, c}, {a, b, d}));
+  // A face whose opposite edge crosses the other face.
+  ASSERT_FALSE(face_face.touches_only_at_shared_vertices(a, b, c, e, a, f));
+  ASSERT_TRUE(test(points, {a, b, c}, {a, e, f}));
+}
+
 TEST(FaceFaceIntersectionTest, IntersectingCubes1) {
   Point_list points;
   auto left_cube = make_cube(points, {0.0, 0.0, 0.0}, {1.0, 1.0, 1.0});
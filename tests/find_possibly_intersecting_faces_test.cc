@@ -0,0 +1,152 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <gtest/gtest.h>
+#include <kigumi/Face_tag.h>
+#include <kigumi/Find_possibly_intersecting_faces.h>
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Null_data.h>
+#include <kigumi/Triangle_soup.h>
+#include <kigumi/boolean_options.h>
+#include <kigumi/mesh_utility.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "make_sheet.h"
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Find_possibly_intersecting_faces =
+    kigumi::Find_possibly_intersecting_faces<K, kigumi::Null_data>;
+using Triangle_soup = kigumi::Triangle_soup<K>;
+using kigumi::Boolean_context;
+using kigumi::Broad_phase_strategy;
+using kigumi::Face_index;
+using kigumi::Face_tag;
+using kigumi::Vertex_index;
+
+namespace {
+
+void append(Triangle_soup& soup, const Triangle_soup& other) {
+  auto num_vertices = soup.num_vertices();
+  for (auto vi : other.vertices()) {
+    soup.add_vertex(other.point(vi));
+  }
+  for (auto fi : other.faces()) {
+    const auto& f = other.face(fi);
+    soup.add_face({Vertex_index{num_vertices + f[0].idx()}, Vertex_index{num_vertices + f[1].idx()},
+                   Vertex_index{num_vertices + f[2].idx()}});
+  }
+}
+
+std::vector<std::pair<Face_index, Face_index>> find_pairs(const Triangle_soup& left,
+                                                          const Triangle_soup& right,
+                                                          Broad_phase_strategy strategy) {
+  auto opts = Boolean_context::current();
+  opts.set_broad_phase_strategy(strategy);
+  Boolean_context ctx{opts};
+
+  std::vector<Face_tag> left_face_tags(left.num_faces());
+  std::vector<Face_tag> right_face_tags(right.num_faces());
+  auto pairs = Find_possibly_intersecting_faces{}(left, right, left_face_tags, right_face_tags);
+  std::sort(pairs.begin(), pairs.end());
+  return pairs;
+}
+
+std::vector<std::pair<Face_index, Face_index>> find_pairs_brute_force(const Triangle_soup& left,
+                                                                      const Triangle_soup& right) {
+  std::vector<std::pair<Face_index, Face_index>> pairs;
+  for (auto left_fi : left.faces()) {
+    auto left_bbox = kigumi::internal::face_bbox(left, left_fi);
+    for (auto right_fi : right.faces()) {
+      if (CGAL::do_overlap(left_bbox, kigumi::internal::face_bbox(right, right_fi))) {
+        pairs.emplace_back(left_fi, right_fi);
+      }
+    }
+  }
+  return pairs;
+}
+
+}  // namespace
+
+TEST(FindPossiblyIntersectingFacesTest, UniformGrid) {
+  auto left = make_sheet<K>(20, 0.0, 0.0);
+  auto right = make_sheet<K>(30, 0.3, 1.0);
+
+  auto tree_pairs = find_pairs(left, right, Broad_phase_strategy::AABB_TREE);
+  auto grid_pairs = find_pairs(left, right, Broad_phase_strategy::UNIFORM_GRID);
+
+  ASSERT_FALSE(tree_pairs.empty());
+  ASSERT_EQ(tree_pairs, grid_pairs);
+}
+
+TEST(FindPossiblyIntersectingFacesTest, Automatic) {
+  auto left = make_sheet<K>(10, 0.0, 0.0);
+  auto right = make_sheet<K>(40, 0.3, 1.0);
+
+  auto tree_pairs = find_pairs(left, right, Broad_phase_strategy::AABB_TREE);
+  auto auto_pairs = find_pairs(left, right, Broad_phase_strategy::AUTOMATIC);
+
+  ASSERT_FALSE(tree_pairs.empty());
+  ASSERT_EQ(tree_pairs, auto_pairs);
+}
+
+TEST(FindPossiblyIntersectingFacesTest, Disjoint) {
+  auto left = make_sheet<K>(10, 0.0, 0.0);
+  auto right = make_sheet<K>(10, 2.0, 0.0);
+
+  ASSERT_TRUE(find_pairs(left, right, Broad_phase_strategy::AABB_TREE).empty());
+  ASSERT_TRUE(find_pairs(left, right, Broad_phase_strategy::UNIFORM_GRID).empty());
+  ASSERT_TRUE(find_pairs(left, right, Broad_phase_strategy::AUTOMATIC).empty());
+}
+
+TEST(FindPossiblyIntersectingFacesTest, CornerOverlap) {
+  auto left = make_sheet<K>(20, 0.0, 0.0);
+  auto right = make_sheet<K>(20, 0.9, 1.0);
+
+  auto expected = find_pairs_brute_force(left, right);
+
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(find_pairs(left, right, Broad_phase_strategy::AABB_TREE), expected);
+  ASSERT_EQ(find_pairs(left, right, Broad_phase_strategy::UNIFORM_GRID), expected);
+  ASSERT_EQ(find_pairs(left, right, Broad_phase_strategy::AUTOMATIC), expected);
+}
+
+TEST(FindPossiblyIntersectingFacesTest, ManyComponents) {
+  Triangle_soup left;
+  for (auto i = 0; i < 4; ++i) {
+    append(left, make_sheet<K>(5, 1.2 * i, 0.0));
+  }
+  auto right = make_sheet<K>(20, 0.9, 1.0);
+
+  auto expected = find_pairs_brute_force(left, right);
+
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(find_pairs(left, right, Broad_phase_strategy::AABB_TREE), expected);
+  ASSERT_EQ(find_pairs(left, right, Broad_phase_strategy::UNIFORM_GRID), expected);
+  ASSERT_EQ(find_pairs(left, right, Broad_phase_strategy::AUTOMATIC), expected);
+}
+
+TEST(FindPossiblyIntersectingFacesTest, LargeFaces) {
+  // Ground planes much larger than the faces of the sheets.
+  auto make_plane = [](double min, double max, double z) {
+    Triangle_soup soup;
+    auto vi1 = soup.add_vertex({min, min, z});
+    auto vi2 = soup.add_vertex({max, min, z});
+    auto vi3 = soup.add_vertex({max, max, z});
+    auto vi4 = soup.add_vertex({min, max, z});
+    soup.add_face({vi1, vi2, vi3});
+    soup.add_face({vi1, vi3, vi4});
+    return soup;
+  };
+
+  auto left = make_sheet<K>(20, 0.0, 0.0);
+  append(left, make_plane(-10.0, 11.0, 0.0));
+  auto right = make_sheet<K>(30, 0.3, 1.0);
+  append(right, make_plane(-5.0, 6.0, 0.05));
+
+  auto expected = find_pairs_brute_force(left, right);
+
+  ASSERT_FALSE(expected.empty());
+  ASSERT_EQ(find_pairs(left, right, Broad_phase_strategy::UNIFORM_GRID), expected);
+  ASSERT_EQ(find_pairs(left, right, Broad_phase_strategy::AUTOMATIC), expected);
+}
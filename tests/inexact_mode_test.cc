@@ -0,0 +1,112 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <CGAL/Kernel/global_functions.h>
+#include <CGAL/number_utils.h>
+#include <gtest/gtest.h>
+#include <kigumi/Boolean_operator.h>
+#include <kigumi/Boolean_region_builder.h>
+#include <kigumi/Region.h>
+#include <kigumi/Triangle_soup.h>
+#include <kigumi/Warnings.h>
+#include <kigumi/boolean_options.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "make_cube.h"
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using FT = K::FT;
+using Point = K::Point_3;
+using kigumi::Boolean_context;
+using kigumi::Boolean_operator;
+using kigumi::Boolean_region_builder;
+using kigumi::Warnings;
+
+namespace {
+
+std::vector<Point> sorted_points(const kigumi::Region<K>& region) {
+  std::vector<Point> points;
+  const auto& m = region.boundary();
+  for (auto fi : m.faces()) {
+    for (auto vi : m.face(fi)) {
+      points.push_back(m.point(vi));
+    }
+  }
+  std::sort(points.begin(), points.end());
+  return points;
+}
+
+}  // namespace
+
+TEST(InexactModeTest, SameAsExact) {
+  auto m1 = make_cube<K>({0, 0, 0}, {2, 2, 2}, {});
+  auto m2 = make_cube<K>({1, 1, 1}, {3, 3, 3}, {});
+
+  auto exact = Boolean_region_builder{m1, m2}(Boolean_operator::K);
+
+  auto opts = Boolean_context::current();
+  opts.set_inexact_mode(true);
+  Boolean_context ctx{opts};
+  Boolean_region_builder b{m1, m2};
+  ASSERT_NE(b.warnings() & Warnings::INEXACT_INTERSECTION_POINTS, Warnings::NONE);
+  auto inexact = b(Boolean_operator::K);
+
+  ASSERT_EQ(inexact.boundary().num_faces(), exact.boundary().num_faces());
+  ASSERT_EQ(sorted_points(inexact), sorted_points(exact));
+}
+
+TEST(InexactModeTest, RoundedIntersectionPoints) {
+  auto m1 = make_cube<K>({0, 0, 0}, {1, 1, 1}, {});
+
+  // A tetrahedron that cuts the cube at points that are not representable by doubles.
+  kigumi::Triangle_soup<K> soup;
+  auto vi1 = soup.add_vertex({0.3, 0.4, -1.0});
+  auto vi2 = soup.add_vertex({2.1, 0.2, 2.0});
+  auto vi3 = soup.add_vertex({-1.3, 0.3, 2.2});
+  auto vi4 = soup.add_vertex({0.6, 2.7, 1.9});
+  soup.add_face({vi2, vi4, vi3});
+  soup.add_face({vi1, vi3, vi4});
+  soup.add_face({vi1, vi4, vi2});
+  soup.add_face({vi1, vi2, vi3});
+  kigumi::Region<K> m2{std::move(soup)};
+
+  auto exact = Boolean_region_builder{m1, m2}(Boolean_operator::K);
+
+  auto opts = Boolean_context::current();
+  opts.set_inexact_mode(true);
+  Boolean_context ctx{opts};
+  Boolean_region_builder b{m1, m2};
+  ASSERT_NE(b.warnings() & Warnings::INEXACT_INTERSECTION_POINTS, Warnings::NONE);
+  auto inexact = b(Boolean_operator::K);
+
+  ASSERT_EQ(inexact.boundary().num_faces(), exact.boundary().num_faces());
+  auto exact_points = sorted_points(exact);
+  auto inexact_points = sorted_points(inexact);
+  for (std::size_t i = 0; i < exact_points.size(); ++i) {
+    ASSERT_LT(CGAL::to_double(CGAL::squared_distance(exact_points.at(i), inexact_points.at(i))),
+              1e-24);
+  }
+}
+
+TEST(InexactModeTest, NonDoubleInputs) {
+  // The coordinates are not representable by doubles, as in the results of previous operations.
+  auto third = FT{1} / 3;
+  auto m1 = make_cube<K>({third, third, third}, {2, 2, 2}, {});
+  auto m2 = make_cube<K>({1, 1, 1}, {3, 3, 3}, {});
+
+  auto exact = Boolean_region_builder{m1, m2}(Boolean_operator::A);
+
+  auto opts = Boolean_context::current();
+  opts.set_inexact_mode(true);
+  Boolean_context ctx{opts};
+  Boolean_region_builder b{m1, m2};
+  ASSERT_EQ(b.warnings() & Warnings::INEXACT_INTERSECTION_POINTS, Warnings::NONE);
+  auto inexact = b(Boolean_operator::A);
+
+  ASSERT_EQ(inexact.boundary().num_faces(), exact.boundary().num_faces());
+  ASSERT_EQ(sorted_points(inexact), sorted_points(exact));
+  ASSERT_TRUE(std::any_of(inexact.boundary().vertices_begin(), inexact.boundary().vertices_end(),
+                          [&](auto vi) { return inexact.boundary().point(vi).x() == third; }));
+}
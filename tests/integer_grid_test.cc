@@ -0,0 +1,76 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <gtest/gtest.h>
+#include <kigumi/Integer_grid.h>
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Triangle_soup.h>
+
+#include <cstddef>
+#include <stdexcept>
+
+#include "make_cube.h"
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Point = K::Point_3;
+using Triangle_soup = kigumi::Triangle_soup<K>;
+using kigumi::scale_from_integer_grid;
+using kigumi::snap_to_integer_grid;
+using kigumi::Vertex_index;
+
+TEST(IntegerGridTest, Snap) {
+  Triangle_soup soup;
+  auto vi1 = soup.add_vertex({0.0, 0.0, 0.0});
+  auto vi2 = soup.add_vertex({1.0000004, 0.0, 0.0});
+  auto vi3 = soup.add_vertex({0.0, -0.9999996, 0.25});
+  soup.add_face({vi1, vi2, vi3});
+
+  auto snapped = snap_to_integer_grid(soup, 1e-6);
+  ASSERT_EQ(snapped.num_faces(), std::size_t{1});
+  ASSERT_EQ(snapped.point(Vertex_index{1}), Point(1000000, 0, 0));
+  ASSERT_EQ(snapped.point(Vertex_index{2}), Point(0, -1000000, 250000));
+
+  auto scaled = scale_from_integer_grid(snapped, 0.5);
+  ASSERT_EQ(scaled.point(Vertex_index{2}), Point(0, -500000, 125000));
+
+  ASSERT_THROW(snap_to_integer_grid(soup, 1e-20), std::invalid_argument);
+  ASSERT_THROW(snap_to_integer_grid(soup, 0.0), std::invalid_argument);
+}
+
+TEST(IntegerGridTest, OnGrid) {
+  auto soup = make_cube<K>({0, 0, 0}, {1, 1, 1}, {}).boundary();
+
+  auto snapped = snap_to_integer_grid(soup, 0.25);
+  ASSERT_EQ(snapped.point(Vertex_index{7}), Point(4, 4, 4));
+
+  auto scaled = scale_from_integer_grid(snapped, 0.25);
+  for (auto vi : soup.vertices()) {
+    ASSERT_EQ(scaled.point(vi), soup.point(vi));
+  }
+}
+
+TEST(IntegerGridTest, Degenerate) {
+  // The third vertex snaps onto the line through the others.
+  Triangle_soup soup;
+  auto vi1 = soup.add_vertex({0.0, 0.0, 0.0});
+  auto vi2 = soup.add_vertex({1.0, 0.0, 0.0});
+  auto vi3 = soup.add_vertex({0.5, 0.1, 0.0});
+  soup.add_face({vi1, vi2, vi3});
+
+  ASSERT_NO_THROW(snap_to_integer_grid(soup, 0.1));
+  ASSERT_THROW(snap_to_integer_grid(soup, 0.5), std::invalid_argument);
+}
+
+TEST(IntegerGridTest, Intersecting) {
+  // The second face snaps onto the plane of the first one and overlaps it.
+  Triangle_soup soup;
+  auto vi1 = soup.add_vertex({0.0, 0.0, 0.0});
+  auto vi2 = soup.add_vertex({2.0, 0.0, 0.0});
+  auto vi3 = soup.add_vertex({0.0, 2.0, 0.0});
+  auto vi4 = soup.add_vertex({0.5, 0.5, 0.1});
+  auto vi5 = soup.add_vertex({1.5, 0.5, 0.1});
+  auto vi6 = soup.add_vertex({0.5, 1.5, 0.1});
+  soup.add_face({vi1, vi2, vi3});
+  soup.add_face({vi4, vi5, vi6});
+
+  ASSERT_NO_THROW(snap_to_integer_grid(soup, 0.1));
+  ASSERT_THROW(snap_to_integer_grid(soup, 0.5), std::invalid_argument);
+}
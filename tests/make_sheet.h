@@ -0,0 +1,33 @@
+#pragma once
+
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Null_data.h>
+#include <kigumi/Triangle_soup.h>
+
+#include <cmath>
+#include <cstddef>
+
+// A wavy sheet over [offset, offset + 1]^2 tessellated into 2 * n * n triangles of uniform size.
+template <class K, class FaceData = kigumi::Null_data>
+kigumi::Triangle_soup<K, FaceData> make_sheet(std::size_t n, double offset, double phase) {
+  kigumi::Triangle_soup<K, FaceData> soup;
+
+  for (std::size_t j = 0; j <= n; ++j) {
+    for (std::size_t i = 0; i <= n; ++i) {
+      auto x = offset + static_cast<double>(i) / static_cast<double>(n);
+      auto y = offset + static_cast<double>(j) / static_cast<double>(n);
+      auto z = 0.1 * std::sin(6.0 * x + phase) * std::cos(6.0 * y + phase);
+      soup.add_vertex({x, y, z});
+    }
+  }
+
+  auto vi = [n](std::size_t i, std::size_t j) { return kigumi::Vertex_index{j * (n + 1) + i}; };
+  for (std::size_t j = 0; j < n; ++j) {
+    for (std::size_t i = 0; i < n; ++i) {
+      soup.add_face({vi(i, j), vi(i + 1, j), vi(i + 1, j + 1)});
+      soup.add_face({vi(i, j), vi(i + 1, j + 1), vi(i, j + 1)});
+    }
+  }
+
+  return soup;
+}
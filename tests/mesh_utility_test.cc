@@ -0,0 +1,89 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <CGAL/version.h>
+#include <gtest/gtest.h>
+#include <kigumi/Boolean_operator.h>
+#include <kigumi/Boolean_region_builder.h>
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Region.h>
+#include <kigumi/Triangle_soup.h>
+#include <kigumi/mesh_utility.h>
+
+#include <cstddef>
+#include <utility>
+
+#include "make_cube.h"
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using Point = K::Point_3;
+using Triangle_soup = kigumi::Triangle_soup<K>;
+using kigumi::Boolean_operator;
+using kigumi::Boolean_region_builder;
+using kigumi::Vertex_index;
+using kigumi::internal::flatten_point;
+using kigumi::internal::has_exact_value;
+
+TEST(MeshUtilityTest, FlattenPoint) {
+  Point a{0.0, 0.0, 0.0};
+  Point b{1.0, 1.0, 1.0};
+  Point c{0.0, 1.0, 0.0};
+
+  auto p = CGAL::midpoint(a, b);
+  auto q = CGAL::centroid(a, b, c);
+  q.exact();
+
+  ASSERT_EQ(flatten_point(p), p);
+  ASSERT_EQ(flatten_point(q), q);
+
+  Triangle_soup soup;
+  auto vi1 = soup.add_vertex(a);
+  auto vi2 = soup.add_vertex(q);
+  auto vi3 = soup.add_vertex(c);
+  soup.add_face({vi1, vi2, vi3});
+  soup.flatten_points();
+  ASSERT_EQ(soup.point(Vertex_index{1}), q);
+}
+
+TEST(MeshUtilityTest, LazyIntersectionPoints) {
+#if CGAL_VERSION_NR < CGAL_VERSION_NUMBER(5, 5, 0)
+  GTEST_SKIP() << "the intersection points are evaluated eagerly before CGAL 5.5";
+#endif
+
+  auto m1 = make_cube<K>({0, 0, 0}, {1, 1, 1}, {});
+
+  // A tetrahedron that cuts the cube at points that are not representable by doubles.
+  Triangle_soup soup;
+  auto vi1 = soup.add_vertex({0.3, 0.4, -1.0});
+  auto vi2 = soup.add_vertex({2.1, 0.2, 2.0});
+  auto vi3 = soup.add_vertex({-1.3, 0.3, 2.2});
+  auto vi4 = soup.add_vertex({0.6, 2.7, 1.9});
+  soup.add_face({vi2, vi4, vi3});
+  soup.add_face({vi1, vi3, vi4});
+  soup.add_face({vi1, vi4, vi2});
+  soup.add_face({vi1, vi2, vi3});
+  kigumi::Region<K> m2{std::move(soup)};
+
+  auto result = Boolean_region_builder{m1, m2}(Boolean_operator::K);
+  const auto& m = result.boundary();
+
+  // The cut is generic, so the interval filters decide the predicates on most of the
+  // intersection points, and those points must not be evaluated exactly.
+  std::size_t num_inexact{};
+  std::size_t num_evaluated{};
+  for (auto vi : m.vertices()) {
+    const auto& p = m.point(vi);
+    const auto& approx = p.approx();
+    if (approx.x().is_point() && approx.y().is_point() && approx.z().is_point()) {
+      continue;
+    }
+    ++num_inexact;
+    auto has_exact = has_exact_value(p);
+    if (!has_exact) {
+      GTEST_SKIP() << "the lazy representation is not exposed";
+    }
+    if (*has_exact) {
+      ++num_evaluated;
+    }
+  }
+  ASSERT_GT(num_inexact, std::size_t{0});
+  ASSERT_LT(num_evaluated, num_inexact);
+}
@@ -0,0 +1,72 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <gtest/gtest.h>
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Round_vertices.h>
+#include <kigumi/Triangle_soup.h>
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using FT = K::FT;
+using Point = K::Point_3;
+using Triangle_soup = kigumi::Triangle_soup<K>;
+using kigumi::round_vertices;
+using kigumi::Vertex_index;
+
+TEST(RoundVerticesTest, Round) {
+  Triangle_soup soup;
+  auto vi1 = soup.add_vertex({0, 0, 0});
+  auto vi2 = soup.add_vertex({1, 0, 0});
+  auto vi3 = soup.add_vertex({FT{1} / 3, FT{1}, FT{0}});
+  soup.add_face({vi1, vi2, vi3});
+
+  ASSERT_EQ(round_vertices(soup), std::size_t{1});
+  ASSERT_EQ(soup.num_faces(), std::size_t{1});
+  ASSERT_EQ(soup.point(Vertex_index{2}), Point(1.0 / 3.0, 1.0, 0.0));
+  ASSERT_EQ(round_vertices(soup), std::size_t{0});
+}
+
+TEST(RoundVerticesTest, KeepDegenerateFaceExact) {
+  // The y-coordinate underflows to zero when rounded.
+  FT tiny = FT{1} / 3;
+  for (auto i = 0; i < 4; ++i) {
+    tiny = tiny * tiny * FT{1e-100};
+  }
+
+  Triangle_soup soup;
+  auto vi1 = soup.add_vertex({0, 0, 0});
+  auto vi2 = soup.add_vertex({1, 0, 0});
+  auto vi3 = soup.add_vertex({FT{1} / 3, tiny, FT{0}});
+  soup.add_face({vi1, vi2, vi3});
+  auto p = soup.point(vi3);
+
+  ASSERT_EQ(round_vertices(soup), std::size_t{0});
+  ASSERT_EQ(soup.point(vi3), p);
+}
+
+TEST(RoundVerticesTest, KeepOverlappingFaceExact) {
+  // The z-coordinate underflows to zero when rounded.
+  FT tiny = FT{1} / 3;
+  for (auto i = 0; i < 4; ++i) {
+    tiny = tiny * tiny * FT{1e-100};
+  }
+
+  Triangle_soup soup;
+  auto vi1 = soup.add_vertex({0, 0, 0});
+  auto vi2 = soup.add_vertex({1, 0, 0});
+  auto vi3 = soup.add_vertex({0, 1, 0});
+  soup.add_face({vi1, vi2, vi3});
+  // The face touches the interior of the first face when rounded.
+  auto vi4 = soup.add_vertex({FT{1} / 3, FT{1} / 3, tiny});
+  auto vi5 = soup.add_vertex({0, 0, 1});
+  auto vi6 = soup.add_vertex({1, 0, 1});
+  soup.add_face({vi4, vi5, vi6});
+  // The face is far from the others.
+  auto vi7 = soup.add_vertex({FT{10} / 3, FT{0}, FT{0}});
+  auto vi8 = soup.add_vertex({4, 0, 0});
+  auto vi9 = soup.add_vertex({4, 1, 0});
+  soup.add_face({vi7, vi8, vi9});
+  auto p = soup.point(vi4);
+
+  ASSERT_EQ(round_vertices(soup), std::size_t{1});
+  ASSERT_EQ(soup.point(vi4), p);
+  ASSERT_EQ(soup.point(vi7), Point(10.0 / 3.0, 0.0, 0.0));
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <CGAL/number_utils.h>
+#include <kigumi/Mesh_entities.h>
+#include <kigumi/Mesh_indices.h>
+#include <kigumi/Triangle_soup.h>
+
+#include <boost/unordered/unordered_flat_map.hpp>
+#include <initializer_list>
+
+// Splits each face into four at the midpoints of its edges. The midpoints are computed in double
+// precision, which is exact if the coordinates are dyadic fractions, e.g., for the subdivisions of
+// a cube with integer corners.
+template <class K, class FaceData>
+kigumi::Triangle_soup<K, FaceData> subdivide(const kigumi::Triangle_soup<K, FaceData>& m) {
+  using kigumi::Vertex_index;
+
+  kigumi::Triangle_soup<K, FaceData> soup;
+  for (auto vi : m.vertices()) {
+    soup.add_vertex(m.point(vi));
+  }
+
+  boost::unordered_flat_map<kigumi::Edge, Vertex_index, kigumi::Edge_hash> midpoints;
+  auto midpoint = [&](Vertex_index a, Vertex_index b) {
+    auto [it, inserted] = midpoints.emplace(kigumi::make_edge(a, b), Vertex_index{});
+    if (inserted) {
+      const auto& p = m.point(a);
+      const auto& q = m.point(b);
+      it->second = soup.add_vertex({(CGAL::to_double(p.x()) + CGAL::to_double(q.x())) / 2.0,
+                                    (CGAL::to_double(p.y()) + CGAL::to_double(q.y())) / 2.0,
+                                    (CGAL::to_double(p.z()) + CGAL::to_double(q.z())) / 2.0});
+    }
+    return it->second;
+  };
+
+  for (auto fi : m.faces()) {
+    const auto& [a, b, c] = m.face(fi);
+    auto ab = midpoint(a, b);
+    auto bc = midpoint(b, c);
+    auto ca = midpoint(c, a);
+    for (const auto& f : {kigumi::Face{a, ab, ca}, kigumi::Face{ab, b, bc},
+                          kigumi::Face{ca, bc, c}, kigumi::Face{ab, bc, ca}}) {
+      auto fi_new = soup.add_face(f);
+      soup.data(fi_new) = m.data(fi);
+    }
+  }
+
+  return soup;
+}
@@ -0,0 +1,140 @@
+#include <CGAL/Exact_predicates_exact_constructions_kernel.h>
+#include <gtest/gtest.h>
+#include <kigumi/Mesh_entities.h>
+#include <kigumi/Triangle_region.h>
+#include <kigumi/Triangulation.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+using K = CGAL::Exact_predicates_exact_constructions_kernel;
+using FT = K::FT;
+using Point = K::Point_3;
+using Triangulation = kigumi::Triangulation<K>;
+using kigumi::Face;
+using kigumi::Triangle_region;
+
+namespace {
+
+// Returns true if the faces are counterclockwise and tile the triangle of the first three points
+// on the xy plane, and the constraints are the edges of the faces.
+bool test(Triangulation& triangulation, const std::vector<Point>& points,
+          const std::vector<std::pair<std::size_t, std::size_t>>& constraints,
+          std::size_t expected_num_faces) {
+  std::vector<Face> faces;
+  auto count = triangulation.get_faces(std::back_inserter(faces));
+  if (count != expected_num_faces || faces.size() != expected_num_faces) {
+    return false;
+  }
+
+  auto area = [&](std::size_t a, std::size_t b, std::size_t c) {
+    auto u = points.at(b) - points.at(a);
+    auto v = points.at(c) - points.at(a);
+    return u.x() * v.y() - u.y() * v.x();
+  };
+
+  FT sum{0};
+  for (const auto& f : faces) {
+    auto face_area = area(f[0].idx(), f[1].idx(), f[2].idx());
+    if (face_area <= 0) {
+      return false;
+    }
+    sum += face_area;
+  }
+  if (sum != area(0, 1, 2)) {
+    return false;
+  }
+
+  return std::all_of(constraints.begin(), constraints.end(), [&](const auto& constraint) {
+    return std::any_of(faces.begin(), faces.end(), [&](const auto& f) {
+      auto has = [&](std::size_t i) {
+        return std::any_of(f.begin(), f.end(), [&](auto vi) { return vi.idx() == i; });
+      };
+      return has(constraint.first) && has(constraint.second);
+    });
+  });
+}
+
+}  // namespace
+
+TEST(TriangulationTest, EdgeToEdge) {
+  std::vector<Point> points{{0, 0, 0}, {4, 0, 0}, {0, 4, 0}, {2, 0, 0}, {2, 2, 0}};
+  Triangulation triangulation{Triangle_region::LEFT_FACE, points[0], points[1], points[2], 0, 1,
+                              2};
+  auto m = triangulation.insert(points[3], 3, Triangle_region::LEFT_EDGE_01);
+  auto n = triangulation.insert(points[4], 4, Triangle_region::LEFT_EDGE_12);
+  triangulation.insert_constraint(m, n);
+
+  ASSERT_TRUE(test(triangulation, points, {{3, 4}}, 3));
+}
+
+TEST(TriangulationTest, EdgeToEdgeDiagonal) {
+  std::vector<Point> points{{0, 0, 0}, {4, 0, 0}, {0, 4, 0}, {2, 0, 0}, {2, 2, 0}};
+  Triangulation triangulation{Triangle_region::LEFT_FACE, points[0], points[1], points[2], 0, 1,
+                              2};
+  auto a = triangulation.insert(points[0], 0, Triangle_region::LEFT_VERTEX_0);
+  auto m = triangulation.insert(points[3], 3, Triangle_region::LEFT_EDGE_01);
+  auto n = triangulation.insert(points[4], 4, Triangle_region::LEFT_EDGE_12);
+  triangulation.insert_constraint(m, n);
+  triangulation.insert_constraint(a, n);
+
+  ASSERT_TRUE(test(triangulation, points, {{3, 4}, {0, 4}}, 3));
+}
+
+TEST(TriangulationTest, EdgeToFace) {
+  std::vector<Point> points{{0, 0, 0}, {4, 0, 0}, {0, 4, 0}, {2, 0, 0}, {1, 1, 0}};
+  Triangulation triangulation{Triangle_region::RIGHT_FACE, points[0], points[1], points[2], 0, 1,
+                              2};
+  auto m = triangulation.insert(points[3], 3, Triangle_region::RIGHT_EDGE_01);
+  auto n = triangulation.insert(points[4], 4, Triangle_region::RIGHT_FACE);
+  triangulation.insert_constraint(m, n);
+
+  ASSERT_TRUE(test(triangulation, points, {{3, 4}}, 4));
+}
+
+TEST(TriangulationTest, Complex) {
+  std::vector<Point> points{{0, 0, 0}, {4, 0, 0}, {0, 4, 0}, {1, 1, 0}, {2, 1, 0}, {1, 2, 0}};
+  Triangulation triangulation{Triangle_region::LEFT_FACE, points[0], points[1], points[2], 0, 1,
+                              2};
+  auto p = triangulation.insert(points[3], 3, Triangle_region::LEFT_FACE);
+  auto q = triangulation.insert(points[4], 4, Triangle_region::LEFT_FACE);
+  auto r = triangulation.insert(points[5], 5, Triangle_region::LEFT_FACE);
+  triangulation.insert_constraint(p, q);
+  triangulation.insert_constraint(q, r);
+  triangulation.insert_constraint(r, p);
+
+  ASSERT_TRUE(test(triangulation, points, {{3, 4}, {4, 5}, {5, 3}}, 7));
+}
+
+TEST(TriangulationTest, Reset) {
+  // The normal of the first face points in the negative z direction.
+  std::vector<Point> points{{0.0, 0.0, 0.0}, {0.0, 4.0, 1.0},  {4.0, 0.0, 1.0},
+                            {1.0, 1.0, 0.5}, {1.0, 2.0, 0.75}, {2.0, 1.0, 0.75}};
+  Triangulation triangulation{Triangle_region::LEFT_FACE, points[0], points[1], points[2], 0, 1,
+                              2};
+  for (std::size_t i = 3; i < 6; ++i) {
+    triangulation.insert(points[i], i, Triangle_region::LEFT_FACE);
+  }
+  triangulation.insert_constraint(3, 4);
+  triangulation.insert_constraint(4, 5);
+
+  std::vector<Face> faces;
+  ASSERT_EQ(triangulation.get_faces(std::back_inserter(faces)), std::size_t{7});
+  auto normal = CGAL::normal(points[0], points[1], points[2]);
+  for (const auto& f : faces) {
+    auto face_normal = CGAL::normal(points.at(f[0].idx()), points.at(f[1].idx()),
+                                    points.at(f[2].idx()));
+    ASSERT_GT(face_normal * normal, 0);
+  }
+
+  std::vector<Point> points2{{0, 0, 0}, {4, 0, 0}, {0, 4, 0}, {2, 0, 0}, {2, 2, 0}};
+  triangulation.reset(Triangle_region::RIGHT_FACE, points2[0], points2[1], points2[2], 0, 1, 2);
+  auto m = triangulation.insert(points2[3], 3, Triangle_region::RIGHT_EDGE_01);
+  auto n = triangulation.insert(points2[4], 4, Triangle_region::RIGHT_EDGE_12);
+  triangulation.insert_constraint(m, n);
+
+  ASSERT_TRUE(test(triangulation, points2, {{3, 4}}, 3));
+}